@@ -0,0 +1,349 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file yate_bench.c
+ * @brief File containing the end to end benchmark of the editor.
+ * @details The editor is driven with scripted input on a synthetic file. The
+ * input is read from a pipe and the frames are written to /dev/null instead of
+ * a terminal. For every phase of the script the latency of the frames, that
+ * is the time between the input becoming available and the frame being
+ * written, and the amount of bytes per frame are reported.
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config_reader.h"
+#include "editor.h"
+
+/// Maximum amount of frames that are recorded for a single phase
+#define BENCH_MAXIMUM_FRAMES (1 << 16)
+
+/// Settings of a benchmark run
+typedef struct {
+    /// The amount of lines of the synthetic file
+    uint32_t lines;
+    /// The amount of characters per line of the synthetic file
+    uint32_t lineLength;
+    /// The amount of rows of the virtual terminal
+    uint32_t rows;
+    /// The amount of columns of the virtual terminal
+    uint32_t columns;
+    /// The amount of characters that are typed
+    uint32_t keys;
+    /// The extension of the synthetic file, it determines the syntax highlighting
+    char const * extension;
+} bench_settings_t;
+
+/// The frames that were drawn during a phase of the script
+typedef struct {
+    /// The latency of every frame in nanoseconds
+    uint64_t * latencies;
+    /// The amount of bytes that were written for every frame
+    size_t * bytes;
+    /// The amount of frames
+    uint32_t count;
+} bench_phase_t;
+
+/// The phase the frames are currently recorded for
+static bench_phase_t * currentPhase;
+/// Point in time the latency of the next frame is measured from
+static uint64_t frameStart;
+/// Write end of the pipe, the editor reads its input from
+static int inputPipe;
+
+static int bench_compare(void const *, void const *);
+static void bench_create_file(bench_settings_t const *, char *, size_t);
+static void bench_die(char const *);
+static void bench_feed(char const *, size_t);
+static uint64_t bench_now();
+static void bench_on_frame(size_t);
+static bool bench_parse_arguments(int, char const **, bench_settings_t *);
+static void bench_print_usage();
+static void bench_report(char const *, bench_phase_t *);
+static void bench_start_phase(bench_phase_t *);
+
+/// @brief Main entry point of the benchmark
+/// @param argc The amount of arguments that were specified by the user
+/// @param argv The arguments that were spepcified by the user
+/// @return 0 if the benchmark was run, 1 if not
+int main(int argc, char const ** argv) {
+    bench_settings_t settings = {100000, 80, 50, 160, 1000, "c"};
+    if (!bench_parse_arguments(argc, argv, &settings)) {
+        bench_print_usage();
+        return 1;
+    }
+    char path[256];
+    bench_create_file(&settings, path, sizeof(path));
+
+    int descriptors[2];
+    if (pipe(descriptors) == -1 || fcntl(descriptors[0], F_SETFL, O_NONBLOCK) == -1) {
+        bench_die("pipe");
+    }
+    inputPipe = descriptors[1];
+    int sink = open("/dev/null", O_WRONLY);
+    if (sink == -1) {
+        bench_die("/dev/null");
+    }
+    // The configuration file of the user is not read, so the results are reproducible
+    configuration_reader_result_t * config = configuration_reader_default_configuration();
+    if (config == NULL) {
+        bench_die("malloc");
+    }
+    config->colorMode = SYNTAX_COLOR_MODE_TRUECOLOR;
+    editor_initialize_with_terminal(config, descriptors[0], sink, settings.rows, settings.columns);
+    editor_set_frame_callback(bench_on_frame);
+
+    bench_phase_t phases[5];
+    bench_start_phase(&phases[0]);
+    editor_open(path);
+    editor_refresh_screen();
+
+    bench_start_phase(&phases[1]);
+    for (uint32_t i = 0; i < settings.keys; i++) {
+        bench_feed(i % 40 == 39 ? "\r" : &"int value = 42; /* typed */ return x;  "[i % 40], 1);
+    }
+
+    bench_start_phase(&phases[2]);
+    for (uint32_t i = 0; i <= settings.lines / (settings.rows > 2 ? settings.rows - 2 : 1); i++) {
+        bench_feed("\x1b[6~", 4);
+    }
+
+    // The prompt only returns once it is closed, so its input is passed at once. Every keystroke in the prompt
+    // draws a frame, the matches are visited with the arrow keys
+    bench_start_phase(&phases[3]);
+    char search[6 + 100 * 3 + 1];
+    memcpy(search, "\x06value", 6);
+    for (uint32_t i = 0; i < 100; i++) {
+        memcpy(search + 6 + i * 3, "\x1b[B", 3);
+    }
+    search[sizeof(search) - 1] = '\r';
+    bench_feed(search, sizeof(search));
+
+    bench_start_phase(&phases[4]);
+    bench_feed("\x13", 1);
+    uint64_t saveStart = bench_now();
+    editor_wait_for_save();
+    uint64_t saveDuration = bench_now() - saveStart;
+
+    printf("%u lines with %u characters, %ux%u terminal\n", settings.lines, settings.lineLength, settings.columns,
+           settings.rows);
+    printf("%-12s %8s %12s %12s %12s %12s %12s\n", "phase", "frames", "p50 (us)", "p90 (us)", "p99 (us)", "max (us)",
+           "bytes/frame");
+    char const * names[] = {"open", "type", "page-down", "search", "save"};
+    for (uint32_t i = 0; i < 5; i++) {
+        bench_report(names[i], &phases[i]);
+    }
+    printf("save completed after %.3f ms\n", saveDuration / 1e6);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("peak RSS: %ld KiB\n", usage.ru_maxrss);
+
+    unlink(path);
+    return 0;
+}
+
+/// @brief Compares two latencies
+/// @param a Pointer to the first latency
+/// @param b Pointer to the second latency
+/// @return -1, 0 or 1 if the first latency is smaller, equal or larger
+static int bench_compare(void const * a, void const * b) {
+    uint64_t left = *(uint64_t const *)a;
+    uint64_t right = *(uint64_t const *)b;
+    return (left > right) - (left < right);
+}
+
+/// @brief Creates the synthetic file the editor is driven on
+/// @param settings The settings of the benchmark
+/// @param path Is set to the path of the file
+/// @param size The size of the path buffer
+static void bench_create_file(bench_settings_t const * settings, char * path, size_t size) {
+    char const * directory = getenv("TMPDIR");
+    int length = snprintf(path, size, "%s/yate_bench_XXXXXX.%s", directory ? directory : "/tmp", settings->extension);
+    if (length < 0 || (size_t)length >= size) {
+        bench_die("snprintf");
+    }
+    int fileDescriptor = mkstemps(path, (int)strlen(settings->extension) + 1);
+    FILE * file = fileDescriptor == -1 ? NULL : fdopen(fileDescriptor, "w");
+    if (file == NULL) {
+        bench_die(path);
+    }
+    // Code, comments, strings and tabs, so the highlighting and the rendering of tabs are measured as well
+    static char const * tokens[] = {"int", "value", "=", "42;", "/* note */", "\"text\"", "\treturn", "count++;",
+                                    "if", "(value)", "// tail"};
+    size_t const tokenCount = sizeof(tokens) / sizeof(tokens[0]);
+    char * line = malloc(settings->lineLength + 1);
+    if (line == NULL) {
+        bench_die("malloc");
+    }
+    for (uint32_t i = 0; i < settings->lines; i++) {
+        uint32_t used = 0;
+        for (size_t token = i % tokenCount; used < settings->lineLength; token = (token + 1) % tokenCount) {
+            // A line comment ends the line, so the other tokens stay visible
+            if (token == tokenCount - 1 && used + strlen(tokens[token]) < settings->lineLength) {
+                break;
+            }
+            used += snprintf(line + used, settings->lineLength + 1 - used, "%s ", tokens[token]);
+            if (used > settings->lineLength) {
+                used = settings->lineLength;
+            }
+        }
+        fwrite(line, 1, used, file);
+        fputc('\n', file);
+    }
+    free(line);
+    if (fclose(file) == EOF) {
+        bench_die(path);
+    }
+}
+
+/// @brief Emits an error message and quits the benchmark
+/// @param message The message that is emitted
+static void bench_die(char const * message) {
+    perror(message);
+    exit(1);
+}
+
+/// @brief Passes input to the editor and processes it
+/// @param input The input that is processed
+/// @param length The length of the input
+/// @details The latency of the frames is measured from the point in time when
+/// the input is available. Afterwards a frame is drawn, like in the main loop
+/// of the editor
+static void bench_feed(char const * input, size_t length) {
+    if (write(inputPipe, input, length) != (ssize_t)length) {
+        bench_die("write");
+    }
+    frameStart = bench_now();
+    editor_process_keypress();
+    editor_refresh_screen();
+}
+
+/// @brief Gets the current time of the monotonic clock
+/// @return The current time in nanoseconds
+static uint64_t bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+/// @brief Records a frame that was drawn by the editor
+/// @param bytesWritten The amount of bytes that were written for the frame
+static void bench_on_frame(size_t bytesWritten) {
+    uint64_t now = bench_now();
+    if (currentPhase->count < BENCH_MAXIMUM_FRAMES) {
+        currentPhase->latencies[currentPhase->count] = now - frameStart;
+        currentPhase->bytes[currentPhase->count++] = bytesWritten;
+    }
+    // The next frame of the same input is measured from the end of this one
+    frameStart = now;
+}
+
+/// @brief Parses the arguments of the benchmark
+/// @param argc The amount of arguments
+/// @param argv The arguments
+/// @param settings The settings that are set by the arguments
+/// @return true if the arguments are valid, false if not
+static bool bench_parse_arguments(int argc, char const ** argv, bench_settings_t * settings) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h") || i + 1 == argc) {
+            return false;
+        }
+        char const * value = argv[++i];
+        if (!strcmp(argv[i - 1], "--extension")) {
+            settings->extension = value;
+            continue;
+        }
+        char * end;
+        errno = 0;
+        unsigned long number = strtoul(value, &end, 10);
+        if (errno || *end != '\0' || number == 0 || number > UINT32_MAX) {
+            return false;
+        }
+        if (!strcmp(argv[i - 1], "--lines")) {
+            settings->lines = (uint32_t)number;
+        } else if (!strcmp(argv[i - 1], "--line-length")) {
+            settings->lineLength = (uint32_t)number;
+        } else if (!strcmp(argv[i - 1], "--rows")) {
+            settings->rows = (uint32_t)number;
+        } else if (!strcmp(argv[i - 1], "--columns")) {
+            settings->columns = (uint32_t)number;
+        } else if (!strcmp(argv[i - 1], "--keys")) {
+            settings->keys = (uint32_t)number;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Displays the usage of the benchmark in the console
+static void bench_print_usage() {
+    printf("Usage yate_bench <option> <value> ...\n\n");
+    printf("Options\n");
+    printf("  --lines\t\tAmount of lines of the synthetic file (default 100000)\n");
+    printf("  --line-length\t\tAmount of characters per line (default 80)\n");
+    printf("  --rows\t\tAmount of rows of the virtual terminal (default 50)\n");
+    printf("  --columns\t\tAmount of columns of the virtual terminal (default 160)\n");
+    printf("  --keys\t\tAmount of characters that are typed (default 1000)\n");
+    printf("  --extension\t\tExtension of the synthetic file (default c)\n");
+}
+
+/// @brief Prints the results of a phase
+/// @param name The name of the phase
+/// @param phase The phase that is reported
+static void bench_report(char const * name, bench_phase_t * phase) {
+    if (!phase->count) {
+        printf("%-12s %8u\n", name, 0u);
+        return;
+    }
+    size_t totalBytes = 0;
+    for (uint32_t i = 0; i < phase->count; i++) {
+        totalBytes += phase->bytes[i];
+    }
+    qsort(phase->latencies, phase->count, sizeof(uint64_t), bench_compare);
+    uint64_t const * latencies = phase->latencies;
+    uint32_t last = phase->count - 1;
+    printf("%-12s %8u %12.1f %12.1f %12.1f %12.1f %12zu\n", name, phase->count, latencies[last * 50 / 100] / 1e3,
+           latencies[last * 90 / 100] / 1e3, latencies[last * 99 / 100] / 1e3, latencies[last] / 1e3,
+           totalBytes / phase->count);
+    free(phase->latencies);
+    free(phase->bytes);
+}
+
+/// @brief Starts recording the frames of a new phase
+/// @param phase The phase that is started
+static void bench_start_phase(bench_phase_t * phase) {
+    phase->latencies = malloc(sizeof(uint64_t) * BENCH_MAXIMUM_FRAMES);
+    phase->bytes = malloc(sizeof(size_t) * BENCH_MAXIMUM_FRAMES);
+    if (phase->latencies == NULL || phase->bytes == NULL) {
+        bench_die("malloc");
+    }
+    phase->count = 0;
+    currentPhase = phase;
+    frameStart = bench_now();
+}
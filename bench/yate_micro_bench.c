@@ -0,0 +1,435 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file yate_micro_bench.c
+ * @brief File containing the micro benchmarks of the hot functions of the
+ * editor.
+ * @details editor.c is included, so its static functions can be called
+ * directly. Every benchmark is repeated until it ran long enough to be
+ * measured, the time and the bytes allocated per operation are reported. The
+ * results can be stored as a baseline, later runs fail if a benchmark got
+ * slower than the baseline allows.
+ */
+
+// Included first, so the feature test macros at its top apply to all headers
+#include "editor.c"
+
+#include <sys/types.h>
+
+/// Default amount of milliseconds a benchmark is repeated for at least
+#define MICRO_BENCH_DEFAULT_DURATION (200)
+
+/// Maximum amount of benchmarks
+#define MICRO_BENCH_MAXIMUM_RESULTS (32)
+
+/// The amount of rows the row benchmarks are run on
+#define MICRO_BENCH_ROW_COUNT (2000)
+
+/// The amount of long rows the lexer benchmarks are run on
+#define MICRO_BENCH_LEXER_ROW_COUNT (64)
+
+/// The amount of characters in the very long row, that is edited
+#define MICRO_BENCH_VERY_LONG_ROW_SIZE (1 << 22)
+
+/// The result of a single benchmark
+typedef struct {
+    /// The name of the benchmark
+    char name[64];
+    /// The amount of nanoseconds per operation
+    double nanoseconds;
+    /// The amount of bytes allocated per operation
+    double bytes;
+} micro_bench_result_t;
+
+/// A line, that contains the tokens of all the supported languages
+static char const sampleLine[] = "\tif (value == 42) { return \"text\"; } /* note */ -- lua # python // tail";
+
+/// Bytes that were allocated since the benchmark was started
+static uint64_t allocatedBytes;
+/// Minimum amount of nanoseconds a benchmark is repeated for
+static uint64_t minimumDuration = (uint64_t)MICRO_BENCH_DEFAULT_DURATION * 1000000;
+/// The results of the benchmarks that were run
+static micro_bench_result_t results[MICRO_BENCH_MAXIMUM_RESULTS];
+/// The amount of results
+static uint32_t resultCount;
+/// Only the benchmarks that contain this string are run, NULL runs all of them
+static char const * filter;
+/// Determines whether the rows start inside of a multiline comment, when they
+/// are highlighted by the lexer benchmarks
+static bool lexerInsideComment;
+
+static void micro_bench_append_buffer_append_string(uint64_t);
+static bool micro_bench_compare_baseline(char const *, double);
+static void micro_bench_copy_buffer_write(uint64_t);
+static void micro_bench_editor_find(uint64_t);
+static void micro_bench_editor_highlight_columns(uint64_t);
+static void micro_bench_editor_row_cx_to_rx(uint64_t);
+static void micro_bench_editor_row_insert_character(uint64_t);
+static void micro_bench_editor_save(uint64_t);
+static void micro_bench_editor_update_row(uint64_t);
+static void micro_bench_editor_update_syntax(uint64_t);
+static void micro_bench_fill_rows(uint32_t, char const *, size_t);
+static void micro_bench_measure(char const *, void (*)(uint64_t));
+static uint64_t micro_bench_now();
+static void micro_bench_print_usage();
+static bool micro_bench_save_baseline(char const *);
+
+#ifdef MICRO_BENCH_COUNT_ALLOCATIONS
+void * __real_calloc(size_t, size_t);
+void * __real_malloc(size_t);
+void * __real_realloc(void *, size_t);
+
+/// @brief Counts the bytes of an allocation, the linker redirects calloc here
+void * __wrap_calloc(size_t count, size_t size) {
+    allocatedBytes += count * size;
+    return __real_calloc(count, size);
+}
+
+/// @brief Counts the bytes of an allocation, the linker redirects malloc here
+void * __wrap_malloc(size_t size) {
+    allocatedBytes += size;
+    return __real_malloc(size);
+}
+
+/// @brief Counts the bytes of an allocation, the linker redirects realloc here
+void * __wrap_realloc(void * pointer, size_t size) {
+    allocatedBytes += size;
+    return __real_realloc(pointer, size);
+}
+#endif
+
+/// @brief Main entry point of the micro benchmarks
+/// @param argc The amount of arguments that were specified by the user
+/// @param argv The arguments that were spepcified by the user
+/// @return 0 if no benchmark regressed, 1 if one did or the arguments are
+/// invalid
+int main(int argc, char const ** argv) {
+    char const * baseline = NULL;
+    char const * savedBaseline = NULL;
+    double tolerance = 10;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc) {
+            micro_bench_print_usage();
+            return 1;
+        }
+        if (!strcmp(argv[i], "--baseline")) {
+            baseline = argv[++i];
+        } else if (!strcmp(argv[i], "--save-baseline")) {
+            savedBaseline = argv[++i];
+        } else if (!strcmp(argv[i], "--tolerance")) {
+            tolerance = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--duration")) {
+            minimumDuration = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else if (!strcmp(argv[i], "--filter")) {
+            filter = argv[++i];
+        } else {
+            micro_bench_print_usage();
+            return 1;
+        }
+    }
+
+    int descriptors[2];
+    int sink = open("/dev/null", O_WRONLY);
+    configuration_reader_result_t * config = configuration_reader_default_configuration();
+    if (pipe(descriptors) == -1 || fcntl(descriptors[0], F_SETFL, O_NONBLOCK) == -1 || sink == -1 || !config) {
+        perror("micro_bench");
+        return 1;
+    }
+    config->colorMode = SYNTAX_COLOR_MODE_TRUECOLOR;
+    editor_initialize_with_terminal(config, descriptors[0], sink, 50, 160);
+
+    printf("%-40s %14s %14s\n", "benchmark", "ns/op", "bytes/op");
+    micro_bench_measure("append_buffer_append_string", micro_bench_append_buffer_append_string);
+    micro_bench_measure("copy_buffer_write", micro_bench_copy_buffer_write);
+    micro_bench_fill_rows(MICRO_BENCH_ROW_COUNT, sampleLine, sizeof(sampleLine) - 1);
+    editorConfig.current->syntax = &HighLightDataBase[0];
+    lexer_compile(&editorConfig.current->lexer, editorConfig.current->syntax);
+    micro_bench_measure("editor_update_row", micro_bench_editor_update_row);
+    for (size_t i = 0; i < syntax_get_language_count(); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "editor_update_syntax/%s", HighLightDataBase[i].filetype);
+        editorConfig.current->syntax = &HighLightDataBase[i];
+        lexer_compile(&editorConfig.current->lexer, editorConfig.current->syntax);
+        editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows = 0;
+        micro_bench_measure(name, micro_bench_editor_update_syntax);
+    }
+    micro_bench_measure("editor_find", micro_bench_editor_find);
+    micro_bench_measure("editor_save", micro_bench_editor_save);
+    // Long rows of code, plain text, a string and a comment, so the lexer can skip through them
+    struct {
+        char const * name;
+        char const * prefix;
+        char const * pattern;
+        bool insideComment;
+    } const lexerRows[] = {
+        {"editor_highlight_columns/code", "", sampleLine, false},
+        {"editor_highlight_columns/text", "", "lorem ipsum_dolor sit amet, consectetur ", false},
+        {"editor_highlight_columns/string", "\"", "lorem ipsum dolor sit amet ", false},
+        {"editor_highlight_columns/comment", "", "lorem ipsum dolor sit amet ", true},
+    };
+    char longRow[8192];
+    editorConfig.current->syntax = &HighLightDataBase[0];
+    lexer_compile(&editorConfig.current->lexer, editorConfig.current->syntax);
+    for (size_t i = 0; i < sizeof(lexerRows) / sizeof(lexerRows[0]); i++) {
+        size_t prefixLength = strlen(lexerRows[i].prefix), patternLength = strlen(lexerRows[i].pattern);
+        memcpy(longRow, lexerRows[i].prefix, prefixLength);
+        for (size_t j = prefixLength; j < sizeof(longRow); j++) {
+            longRow[j] = lexerRows[i].pattern[(j - prefixLength) % patternLength];
+        }
+        micro_bench_fill_rows(MICRO_BENCH_LEXER_ROW_COUNT, longRow, sizeof(longRow));
+        lexerInsideComment = lexerRows[i].insideComment;
+        micro_bench_measure(lexerRows[i].name, micro_bench_editor_highlight_columns);
+    }
+    // A single long row, so the column map of the row is used
+    for (size_t i = 0; i < sizeof(longRow); i++) {
+        longRow[i] = sampleLine[i % (sizeof(sampleLine) - 1)];
+    }
+    micro_bench_fill_rows(1, longRow, sizeof(longRow));
+    micro_bench_measure("editor_row_cx_to_rx", micro_bench_editor_row_cx_to_rx);
+    // A single very long row like a minified file, so only the part around the modification is processed
+    char * veryLongRow = malloc(MICRO_BENCH_VERY_LONG_ROW_SIZE);
+    if (veryLongRow == NULL) {
+        perror("micro_bench");
+        return 1;
+    }
+    for (size_t i = 0; i < MICRO_BENCH_VERY_LONG_ROW_SIZE; i++) {
+        veryLongRow[i] = lexerRows[1].pattern[i % strlen(lexerRows[1].pattern)];
+    }
+    micro_bench_fill_rows(1, veryLongRow, MICRO_BENCH_VERY_LONG_ROW_SIZE);
+    free(veryLongRow);
+    micro_bench_measure("editor_row_insert_character/long", micro_bench_editor_row_insert_character);
+
+    bool passed = true;
+    if (baseline) {
+        passed = micro_bench_compare_baseline(baseline, tolerance);
+    }
+    if (savedBaseline && !micro_bench_save_baseline(savedBaseline)) {
+        perror(savedBaseline);
+        return 1;
+    }
+    return passed ? 0 : 1;
+}
+
+/// @brief Appends short strings to an append buffer, that is reset
+/// periodically like the frame buffer
+/// @param iterations The amount of strings that are appended
+static void micro_bench_append_buffer_append_string(uint64_t iterations) {
+    append_buffer_t buffer;
+    append_buffer_init(&buffer);
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (i % 1024 == 0) {
+            append_buffer_reset(&buffer);
+        }
+        append_buffer_append_string(&buffer, sampleLine, sizeof(sampleLine) - 1);
+    }
+    append_buffer_free(&buffer);
+}
+
+/// @brief Compares the results with a stored baseline
+/// @param path The path of the baseline
+/// @param tolerance The amount of percent a benchmark may be slower than the
+/// baseline
+/// @return true if no benchmark regressed, false if one did or the baseline
+/// could not be read
+static bool micro_bench_compare_baseline(char const * path, double tolerance) {
+    FILE * file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    bool passed = true;
+    char name[64];
+    double nanoseconds;
+    while (fscanf(file, "%63s %lf", name, &nanoseconds) == 2) {
+        for (uint32_t i = 0; i < resultCount; i++) {
+            if (!strcmp(results[i].name, name) && results[i].nanoseconds > nanoseconds * (1 + tolerance / 100)) {
+                printf("REGRESSION %s: %.1f ns/op, baseline %.1f ns/op\n", name, results[i].nanoseconds, nanoseconds);
+                passed = false;
+            }
+        }
+    }
+    fclose(file);
+    return passed;
+}
+
+/// @brief Writes lines to a copy buffer, like yanking does
+/// @param iterations The amount of lines that are written
+static void micro_bench_copy_buffer_write(uint64_t iterations) {
+    copy_buffer_t buffer;
+    copy_buffer_init(&buffer);
+    for (uint64_t i = 0; i < iterations; i++) {
+        copy_buffer_write(&buffer, sampleLine, sizeof(sampleLine) - 1);
+    }
+    copy_buffer_free(&buffer);
+}
+
+/// @brief Searches the rows incrementally, like the find prompt does after
+/// every keystroke
+/// @param iterations The amount of times the rows are searched
+static void micro_bench_editor_find(uint64_t iterations) {
+    char query[] = "value";
+    for (uint64_t i = 0; i < iterations; i++) {
+        editor_find_callback(query, 'e');
+    }
+    editor_find_callback(query, '\r');
+}
+
+/// @brief Highlights long rows without storing the highlighting, so only the
+/// lexer is measured
+/// @param iterations The amount of rows that are highlighted
+static void micro_bench_editor_highlight_columns(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        editor_row_t * row = editor_prepare_row((uint32_t)(i % MICRO_BENCH_LEXER_ROW_COUNT));
+        editor_highlight_columns(row, editor_reserve_highlight_columns(row->renderSize), lexerInsideComment);
+    }
+}
+
+/// @brief Converts cursor positions in a long row to render positions
+/// @param iterations The amount of positions that are converted
+static void micro_bench_editor_row_cx_to_rx(uint64_t iterations) {
+    editor_row_t * row = editor_prepare_row(0);
+    uint32_t checksum = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        checksum += editor_row_cx_to_rx(row, (uint32_t)((i * 7919) % row->size));
+    }
+    // Keeps the conversions from being optimized away
+    if (checksum == UINT32_MAX) {
+        printf("%u\n", checksum);
+    }
+}
+
+/// @brief Inserts characters into a very long row and deletes them again
+/// @param iterations The amount of characters that are inserted or deleted
+static void micro_bench_editor_row_insert_character(uint64_t iterations) {
+    editor_prepare_row(0);
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t at = (uint32_t)((i / 2 * 7919) % MICRO_BENCH_VERY_LONG_ROW_SIZE);
+        if (i % 2 == 0) {
+            editor_row_insert_character(0, at, 'x');
+        } else {
+            editor_row_delete_character(0, at);
+        }
+    }
+}
+
+/// @brief Saves the rows to a temporary file and waits until the background
+/// thread wrote them
+/// @param iterations The amount of times the rows are saved
+static void micro_bench_editor_save(uint64_t iterations) {
+    char const * directory = getenv("TMPDIR");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/yate_micro_bench_%ld.txt", directory ? directory : "/tmp", (long)getpid());
+    editorConfig.current->fileName = strdup(path);
+    for (uint64_t i = 0; i < iterations; i++) {
+        editor_save();
+        editor_finish_save(true);
+    }
+    unlink(path);
+    free(editorConfig.current->fileName);
+    editorConfig.current->fileName = NULL;
+}
+
+/// @brief Renders and highlights rows again, like editing does
+/// @param iterations The amount of rows that are updated
+static void micro_bench_editor_update_row(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        editor_update_row((uint32_t)(i % MICRO_BENCH_ROW_COUNT));
+    }
+}
+
+/// @brief Highlights rows again with the selected syntax
+/// @param iterations The amount of rows that are highlighted
+static void micro_bench_editor_update_syntax(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        editor_update_syntax((uint32_t)(i % MICRO_BENCH_ROW_COUNT));
+    }
+}
+
+/// @brief Replaces the rows of the editor
+/// @param count The amount of rows
+/// @param line The content of every row
+/// @param length The length of the content
+static void micro_bench_fill_rows(uint32_t count, char const * line, size_t length) {
+    editor_free_rows();
+    for (uint32_t at = 0; at < count; at++) {
+        editor_insert_row(at, (char *)line, length);
+    }
+}
+
+/// @brief Runs a benchmark until it ran long enough and records the result
+/// @param name The name of the benchmark
+/// @param benchmark Runs the benchmark for the specified amount of iterations
+static void micro_bench_measure(char const * name, void (*benchmark)(uint64_t)) {
+    if ((filter && !strstr(name, filter)) || resultCount == MICRO_BENCH_MAXIMUM_RESULTS) {
+        return;
+    }
+    // The first run warms up the caches and the allocator
+    benchmark(1);
+    uint64_t iterations = 1;
+    uint64_t elapsed;
+    uint64_t bytes;
+    do {
+        iterations *= 2;
+        allocatedBytes = 0;
+        uint64_t start = micro_bench_now();
+        benchmark(iterations);
+        elapsed = micro_bench_now() - start;
+        bytes = allocatedBytes;
+    } while (elapsed < minimumDuration);
+    micro_bench_result_t * result = &results[resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->nanoseconds = (double)elapsed / iterations;
+    result->bytes = (double)bytes / iterations;
+#ifdef MICRO_BENCH_COUNT_ALLOCATIONS
+    printf("%-40s %14.1f %14.1f\n", result->name, result->nanoseconds, result->bytes);
+#else
+    printf("%-40s %14.1f %14s\n", result->name, result->nanoseconds, "-");
+#endif
+}
+
+/// @brief Gets the current time of the monotonic clock
+/// @return The current time in nanoseconds
+static uint64_t micro_bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+/// @brief Displays the usage of the micro benchmarks in the console
+static void micro_bench_print_usage() {
+    printf("Usage yate_micro_bench <option> <value> ...\n\n");
+    printf("Options\n");
+    printf("  --baseline\t\tFails if a benchmark is slower than in the specified baseline\n");
+    printf("  --save-baseline\tStores the results as a baseline under the specified path\n");
+    printf("  --tolerance\t\tAmount of percent a benchmark may be slower than the baseline (default 10)\n");
+    printf("  --duration\t\tAmount of milliseconds every benchmark is repeated for at least (default %d)\n",
+           MICRO_BENCH_DEFAULT_DURATION);
+    printf("  --filter\t\tOnly runs the benchmarks that contain the specified string\n");
+}
+
+/// @brief Stores the results as a baseline
+/// @param path The path of the baseline
+/// @return true if the baseline was stored, false if not
+static bool micro_bench_save_baseline(char const * path) {
+    FILE * file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < resultCount; i++) {
+        fprintf(file, "%s %.1f\n", results[i].name, results[i].nanoseconds);
+    }
+    return fclose(file) == 0;
+}
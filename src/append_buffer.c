@@ -23,21 +23,37 @@
 #include <stdlib.h>
 #include <string.h>
 
+/// The capacity of an append buffer, when the first string is appended
+#define APPEND_BUFFER_INITIAL_CAPACITY (1024)
+
 void append_buffer_append_string(append_buffer_t * buffer, const char * str, int length) {
-    char * new = realloc(buffer->buffer, buffer->length + length);
-    if (new == NULL) {
-        return;
+    if (buffer->length + length > buffer->capacity) {
+        // The capacity is doubled, so appending is amortized constant
+        size_t newCapacity = buffer->capacity ? buffer->capacity : APPEND_BUFFER_INITIAL_CAPACITY;
+        while (newCapacity < buffer->length + length) {
+            newCapacity *= 2;
+        }
+        char * new = realloc(buffer->buffer, newCapacity);
+        if (new == NULL) {
+            return;
+        }
+        buffer->buffer = new;
+        buffer->capacity = newCapacity;
     }
-    memcpy(&new[buffer->length], str, length);
-    buffer->buffer = new;
+    memcpy(&buffer->buffer[buffer->length], str, length);
     buffer->length += length;
 }
 
 void append_buffer_free(append_buffer_t * buffer) {
     free(buffer->buffer);
+    append_buffer_init(buffer);
 }
 
 void append_buffer_init(append_buffer_t * buffer) {
-    buffer->length = 0;
+    buffer->length = buffer->capacity = 0;
     buffer->buffer = NULL;
+}
+
+void append_buffer_reset(append_buffer_t * buffer) {
+    buffer->length = 0;
 }
\ No newline at end of file
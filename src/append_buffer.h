@@ -28,8 +28,10 @@
 typedef struct {
     /// Pointer to the underlying buffer
     char * buffer;
-    /// The length of the buffer
+    /// The length of the content stored in the buffer
     size_t length;
+    /// The amount of characters that fit into the buffer before it needs to grow
+    size_t capacity;
 } append_buffer_t;
 
 /// @brief Appends a string to an append buffer
@@ -46,4 +48,9 @@ void append_buffer_free(append_buffer_t * buffer);
 /// @param buffer The append buffer that is initialized
 void append_buffer_init(append_buffer_t * buffer);
 
+/// @brief Discards the content of an append buffer, but keeps the memory
+/// that was allocated
+/// @param buffer The append buffer that is reset
+void append_buffer_reset(append_buffer_t * buffer);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,237 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file column_map.c
+ * @brief File containing the implementation of the column map.
+ */
+
+#include "column_map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/// A range of unicode code points, that share the same width
+typedef struct {
+    /// The first code point of the range
+    uint32_t first;
+    /// The last code point of the range
+    uint32_t last;
+} column_map_range_t;
+
+/// Code points that are combined with the previous character and occupy no column
+static column_map_range_t const combiningRanges[] = {
+    {0x0300, 0x036f}, {0x0483, 0x0489}, {0x0591, 0x05bd}, {0x0610, 0x061a}, {0x064b, 0x065f}, {0x0e31, 0x0e31},
+    {0x0e34, 0x0e3a}, {0x0e47, 0x0e4e}, {0x1ab0, 0x1aff}, {0x1dc0, 0x1dff}, {0x200b, 0x200f}, {0x20d0, 0x20ff},
+    {0xfe00, 0xfe0f}, {0xfe20, 0xfe2f}, {0xfeff, 0xfeff},
+};
+
+/// Code points that are displayed with twice the width of other characters
+static column_map_range_t const wideRanges[] = {
+    {0x1100, 0x115f},   {0x2e80, 0x303e},   {0x3041, 0x33ff},   {0x3400, 0x4dbf}, {0x4e00, 0x9fff},
+    {0xa000, 0xa4cf},   {0xac00, 0xd7a3},   {0xf900, 0xfaff},   {0xfe30, 0xfe4f}, {0xff00, 0xff60},
+    {0xffe0, 0xffe6},   {0x1f300, 0x1f64f}, {0x1f900, 0x1f9ff}, {0x20000, 0x2fffd}, {0x30000, 0x3fffd},
+};
+
+static inline void column_map_advance(column_map_position_t *, char const *, uint32_t, uint32_t);
+static uint32_t column_map_decode(char const *, uint32_t, uint32_t, uint32_t *);
+static bool column_map_in_ranges(column_map_range_t const *, size_t, uint32_t);
+static column_map_position_t column_map_start(column_map_t const *, bool, uint32_t);
+
+column_map_t * column_map_create(char const * chars, uint32_t size, uint32_t tabStopSize) {
+    uint32_t capacity = size / COLUMN_MAP_INTERVAL + 1;
+    column_map_t * map = malloc(sizeof(column_map_t) + sizeof(column_map_position_t) * capacity);
+    if (map == NULL) {
+        return NULL;
+    }
+    map->count = 0;
+    column_map_position_t position = {0, 0, 0};
+    uint32_t next = 0;
+    while (position.character < size) {
+        // Checkpoints are only placed at the start of a character, at most one per interval
+        if (position.character >= next) {
+            map->checkpoints[map->count++] = position;
+            next = (position.character / COLUMN_MAP_INTERVAL + 1) * COLUMN_MAP_INTERVAL;
+        }
+        column_map_advance(&position, chars, size, tabStopSize);
+    }
+    return map;
+}
+
+column_map_position_t column_map_find_column(column_map_t const * map, char const * chars, uint32_t size,
+                                             uint32_t tabStopSize, uint32_t column) {
+    column_map_position_t position = column_map_start(map, false, column);
+    while (position.character < size) {
+        column_map_position_t next = position;
+        column_map_advance(&next, chars, size, tabStopSize);
+        if (next.column > column) {
+            break;
+        }
+        position = next;
+    }
+    return position;
+}
+
+column_map_position_t column_map_find_character(column_map_t const * map, char const * chars, uint32_t size,
+                                                uint32_t tabStopSize, uint32_t character) {
+    column_map_position_t position = column_map_start(map, true, character);
+    while (position.character < character && position.character < size) {
+        column_map_advance(&position, chars, size, tabStopSize);
+    }
+    return position;
+}
+
+void column_map_shift(column_map_t * map, uint32_t after, int32_t characterDelta, int32_t positionDelta) {
+    if (map == NULL) {
+        return;
+    }
+    // The checkpoints are sorted, so only the ones at the end of the map are moved
+    uint32_t i = map->count;
+    while (i > 0 && map->checkpoints[i - 1].character > after) {
+        i--;
+    }
+    for (; i < map->count; i++) {
+        map->checkpoints[i].character += characterDelta;
+        map->checkpoints[i].render += positionDelta;
+        map->checkpoints[i].column += positionDelta;
+    }
+}
+
+uint32_t column_map_width(char const * chars, uint32_t size, uint32_t at, uint32_t * length) {
+    uint32_t codePoint = column_map_decode(chars, size, at, length);
+    if (codePoint < 0x80) {
+        // Control characters are displayed as a single symbol
+        return 1;
+    }
+    if (column_map_in_ranges(combiningRanges, sizeof(combiningRanges) / sizeof(combiningRanges[0]), codePoint)) {
+        return 0;
+    }
+    if (column_map_in_ranges(wideRanges, sizeof(wideRanges) / sizeof(wideRanges[0]), codePoint)) {
+        return 2;
+    }
+    return 1;
+}
+
+/// @brief Moves a position to the next character of a row
+/// @param position The position that is moved
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param tabStopSize The amount of columns between two tab stops
+static inline void column_map_advance(column_map_position_t * position, char const * chars, uint32_t size,
+                                      uint32_t tabStopSize) {
+    if (chars[position->character] == '\t') {
+        // Tabs are rendered as white space's up to the next tab stop
+        uint32_t width = tabStopSize - position->column % tabStopSize;
+        position->character++;
+        position->render += width;
+        position->column += width;
+        return;
+    }
+    uint32_t length;
+    position->column += column_map_width(chars, size, position->character, &length);
+    position->character += length;
+    position->render += length;
+}
+
+/// @brief Decodes a single UTF-8 sequence
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param at The index of the first byte of the sequence
+/// @param length Is set to the amount of bytes of the sequence
+/// @return The code point, invalid bytes are decoded as a single character of
+/// their own
+static uint32_t column_map_decode(char const * chars, uint32_t size, uint32_t at, uint32_t * length) {
+    unsigned char const * bytes = (unsigned char const *)&chars[at];
+    uint32_t available = size - at;
+    uint32_t codePoint;
+    uint32_t sequenceLength;
+    if (bytes[0] < 0x80) {
+        *length = 1;
+        return bytes[0];
+    } else if ((bytes[0] & 0xe0) == 0xc0) {
+        codePoint = bytes[0] & 0x1f;
+        sequenceLength = 2;
+    } else if ((bytes[0] & 0xf0) == 0xe0) {
+        codePoint = bytes[0] & 0x0f;
+        sequenceLength = 3;
+    } else if ((bytes[0] & 0xf8) == 0xf0) {
+        codePoint = bytes[0] & 0x07;
+        sequenceLength = 4;
+    } else {
+        *length = 1;
+        return 0xfffd;
+    }
+    if (sequenceLength > available) {
+        *length = 1;
+        return 0xfffd;
+    }
+    for (uint32_t i = 1; i < sequenceLength; i++) {
+        if ((bytes[i] & 0xc0) != 0x80) {
+            *length = 1;
+            return 0xfffd;
+        }
+        codePoint = codePoint << 6 | (bytes[i] & 0x3f);
+    }
+    *length = sequenceLength;
+    return codePoint;
+}
+
+/// @brief Determines whether a code point is part of sorted ranges
+/// @param ranges The ranges that are searched
+/// @param count The amount of ranges
+/// @param codePoint The code point that is searched
+/// @return true if the code point is part of a range, false if not
+static bool column_map_in_ranges(column_map_range_t const * ranges, size_t count, uint32_t codePoint) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (codePoint < ranges[middle].first) {
+            high = middle;
+        } else if (codePoint > ranges[middle].last) {
+            low = middle + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Determines the closest checkpoint before a character or a column
+/// @param map The column map or NULL
+/// @param byCharacter Determines whether the checkpoint is searched by the index
+/// of the character or by the column
+/// @param target The index of the character or the column
+/// @return The checkpoint or the start of the row
+static column_map_position_t column_map_start(column_map_t const * map, bool byCharacter, uint32_t target) {
+    column_map_position_t start = {0, 0, 0};
+    if (map == NULL) {
+        return start;
+    }
+    // Binary search for the last checkpoint that is not after the target
+    uint32_t low = 0;
+    uint32_t high = map->count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        uint32_t value = byCharacter ? map->checkpoints[middle].character : map->checkpoints[middle].column;
+        if (value <= target) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low ? map->checkpoints[low - 1] : start;
+}
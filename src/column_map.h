@@ -0,0 +1,101 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file column_map.h
+ * @brief File containing the declaration of the column map and the
+ * corresponding functions.
+ * @details A column map translates between the index of a character in a row,
+ * the index in the render buffer of the row and the column where the character
+ * is displayed. Tabs are expanded to the next tab stop and UTF-8 sequences are
+ * displayed with their width in the terminal. The map stores checkpoints every
+ * COLUMN_MAP_INTERVAL characters, so a translation only has to process the
+ * characters after the closest checkpoint.
+ */
+
+#ifndef YATE_COLUMN_MAP_H_
+#define YATE_COLUMN_MAP_H_
+
+#include <stdint.h>
+
+/// The minimum amount of characters between two checkpoints of a column map,
+/// rows that are shorter do not need a column map
+#define COLUMN_MAP_INTERVAL (256)
+
+/// Position of a character in a row
+typedef struct {
+    /// Index in the underlying character buffer
+    uint32_t character;
+    /// Index in the render buffer
+    uint32_t render;
+    /// Column where the character is displayed
+    uint32_t column;
+} column_map_position_t;
+
+/// Checkpoints of the positions in a single row
+typedef struct {
+    /// The amount of checkpoints
+    uint32_t count;
+    /// The checkpoints, sorted by their position
+    column_map_position_t checkpoints[];
+} column_map_t;
+
+/// @brief Creates the column map of a row
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param tabStopSize The amount of columns between two tab stops
+/// @return The column map, that is freed with free, or NULL if no memory was
+/// available
+column_map_t * column_map_create(char const * chars, uint32_t size, uint32_t tabStopSize);
+
+/// @brief Determines the position of the character at or after a column
+/// @param map The column map of the row or NULL
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param tabStopSize The amount of columns between two tab stops
+/// @param column The column
+/// @return The position of the character that is displayed at the column, or
+/// the end of the row
+column_map_position_t column_map_find_column(column_map_t const * map, char const * chars, uint32_t size,
+                                             uint32_t tabStopSize, uint32_t column);
+
+/// @brief Determines the position of a character
+/// @param map The column map of the row or NULL
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param tabStopSize The amount of columns between two tab stops
+/// @param character The index of the character
+/// @return The position of the character, or of the next character if the
+/// index is inside of a UTF-8 sequence
+column_map_position_t column_map_find_character(column_map_t const * map, char const * chars, uint32_t size,
+                                                uint32_t tabStopSize, uint32_t character);
+
+/// @brief Moves the checkpoints of a column map after a row was modified
+/// @param map The column map of the row or NULL
+/// @param after The checkpoints after the character with this index are moved
+/// @param characterDelta The amount of characters the checkpoints are moved by
+/// @param positionDelta The amount of render positions and columns the
+/// checkpoints are moved by
+void column_map_shift(column_map_t * map, uint32_t after, int32_t characterDelta, int32_t positionDelta);
+
+/// @brief Determines the width of a single character, that is not a tab
+/// @param chars The characters of the row
+/// @param size The amount of characters in the row
+/// @param at The index of the first byte of the character
+/// @param length Is set to the amount of bytes of the character
+/// @return The amount of columns the character occupies in the terminal
+uint32_t column_map_width(char const * chars, uint32_t size, uint32_t at, uint32_t * length);
+
+#endif
@@ -35,14 +35,30 @@
 /// default duration a status message is diplayed (in seconds)
 #define DEFAULT_STATUS_MESSAGE_DURATION (5)
 
+/// default memory budget of the derived row data (in megabytes), 0 is unlimited
+#define DEFAULT_MEMORY_BUDGET           (0)
+
 static int configuration_reader_parse_configuration_file_line(char **, configuration_reader_result_t **);
 static void configuration_reader_string_behead(char *);
 static void configuration_reader_string_trim(char *);
 
-configuration_reader_result_t * configuration_reader_read_configuration_file() {
+configuration_reader_result_t * configuration_reader_default_configuration() {
     configuration_reader_result_t * result = malloc(sizeof(configuration_reader_result_t));
+    if (!result) {
+        return NULL;
+    }
     result->tabStopSize = DEFAULT_TAB_STOP_SIZE;
     result->messageDisplayDuration = DEFAULT_STATUS_MESSAGE_DURATION;
+    result->colorMode = SYNTAX_COLOR_MODE_AUTOMATIC;
+    result->memoryBudget = DEFAULT_MEMORY_BUDGET;
+    return result;
+}
+
+configuration_reader_result_t * configuration_reader_read_configuration_file() {
+    configuration_reader_result_t * result = configuration_reader_default_configuration();
+    if (!result) {
+        return NULL;
+    }
     char configFilePath[120];
     snprintf(configFilePath, 120, "%s/.yaterc", getenv("HOME"));
     FILE * file = fopen(configFilePath, "rb");
@@ -132,6 +148,22 @@ static int configuration_reader_parse_configuration_file_line(char ** fileConten
         if (isdigit(*argumentRaw) || *argumentRaw == '-') {
             (*result)->messageDisplayDuration = atol(argumentRaw);
         }
+    } else if (!strcasecmp(optionRaw, "MEMORY_BUDGET")) {
+        if (isdigit(*argumentRaw)) {
+            (*result)->memoryBudget = atol(argumentRaw);
+        }
+    } else if (!strcasecmp(optionRaw, "COLOR_MODE")) {
+        if (!strcasecmp(argumentRaw, "truecolor")) {
+            (*result)->colorMode = SYNTAX_COLOR_MODE_TRUECOLOR;
+        } else if (!strcmp(argumentRaw, "256")) {
+            (*result)->colorMode = SYNTAX_COLOR_MODE_256;
+        } else if (!strcmp(argumentRaw, "16")) {
+            (*result)->colorMode = SYNTAX_COLOR_MODE_16;
+        } else if (!strcasecmp(argumentRaw, "monochrome")) {
+            (*result)->colorMode = SYNTAX_COLOR_MODE_MONOCHROME;
+        } else if (!strcasecmp(argumentRaw, "auto")) {
+            (*result)->colorMode = SYNTAX_COLOR_MODE_AUTOMATIC;
+        }
     }
     free(optionRaw);
     free(argumentRaw);
@@ -23,6 +23,7 @@
 #define YATE_CONFIGURATION_READER_H_
 
 #include "stddef.h"
+#include "syntax.h"
 
 /// Result of reading an editor configuration file
 typedef struct {
@@ -31,8 +32,20 @@ typedef struct {
     /// The amount of seconds a message is diplayed within the editor, before it
     /// dissappears
     size_t messageDisplayDuration;
+    /// The colors the terminal supports, detected from the environment by
+    /// default
+    syntax_color_mode_t colorMode;
+    /// The amount of megabytes the render buffers and the syntax highlighting
+    /// of the rows may use, before the least recently used are released - 0 if
+    /// they are never released
+    size_t memoryBudget;
 } configuration_reader_result_t;
 
+/// Allocates a configuration holding the values used when the editor
+/// configuration file does not set them
+/// @return The default configuration, NULL if it could not be allocated
+configuration_reader_result_t * configuration_reader_default_configuration();
+
 /// Parses the editor configuration file located at the users home directory
 /// @return The configuration in the editor configuration file converted to a
 /// configuration_reader_result_t
@@ -24,25 +24,72 @@
 #include <stdlib.h>
 #include <string.h>
 
+/// Factor by which the storage of a copy buffer may exceed the size that is
+/// needed, before it is replaced by smaller storage
+#define COPY_BUFFER_SLACK (4)
+
+/// Size of the storage of a copy buffer, that is never replaced by smaller
+/// storage
+#define COPY_BUFFER_MINIMUM_SIZE (4096)
+
+void copy_buffer_append_line(copy_buffer_t * buffer, char const * str, uint32_t length) {
+    memcpy(&buffer->buffer[buffer->length], str, length);
+    buffer->buffer[buffer->length + length] = '\0';
+    buffer->length += (size_t)length + 1;
+    buffer->lineLengths[buffer->lineCount++] = length;
+}
+
 void copy_buffer_free(copy_buffer_t * buffer) {
     free(buffer->buffer);
+    free(buffer->lineLengths);
     copy_buffer_init(buffer);
 }
 
 void copy_buffer_init(copy_buffer_t * buffer) {
-    buffer->length = 0;
+    buffer->length = buffer->capacity = 0;
     buffer->buffer = NULL;
+    buffer->lineLengths = NULL;
+    buffer->lineCount = buffer->lineCapacity = 0;
 }
 
-void copy_buffer_write(copy_buffer_t * buffer, char const * str, uint32_t length) {
-    char * new = malloc(length);
-    if (new == NULL) {
-        return;
+bool copy_buffer_reset(copy_buffer_t * buffer, size_t length, uint32_t lineCount) {
+    // The storage is kept unless it is too small or much too large, so yanking single lines does not allocate
+    size_t capacity = length + lineCount;
+    char * characters = buffer->buffer;
+    uint32_t * lineLengths = buffer->lineLengths;
+    if (capacity > buffer->capacity || buffer->capacity > COPY_BUFFER_SLACK * capacity + COPY_BUFFER_MINIMUM_SIZE) {
+        characters = malloc(capacity);
+    }
+    if (lineCount > buffer->lineCapacity ||
+        buffer->lineCapacity > COPY_BUFFER_SLACK * lineCount + COPY_BUFFER_MINIMUM_SIZE) {
+        lineLengths = malloc(sizeof(uint32_t) * lineCount);
     }
-    memcpy(new, str, length);
-    if (buffer->buffer) {
+    if (characters == NULL || lineLengths == NULL) {
+        if (characters != buffer->buffer) {
+            free(characters);
+        }
+        if (lineLengths != buffer->lineLengths) {
+            free(lineLengths);
+        }
+        return false;
+    }
+    if (characters != buffer->buffer) {
         free(buffer->buffer);
+        buffer->buffer = characters;
+        buffer->capacity = capacity;
+    }
+    if (lineLengths != buffer->lineLengths) {
+        free(buffer->lineLengths);
+        buffer->lineLengths = lineLengths;
+        buffer->lineCapacity = lineCount;
+    }
+    buffer->length = 0;
+    buffer->lineCount = 0;
+    return true;
+}
+
+void copy_buffer_write(copy_buffer_t * buffer, char const * str, uint32_t length) {
+    if (copy_buffer_reset(buffer, length, 1)) {
+        copy_buffer_append_line(buffer, str, length);
     }
-    buffer->buffer = new;
-    buffer->length = length;
 }
\ No newline at end of file
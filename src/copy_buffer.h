@@ -17,22 +17,41 @@
  * @file copy_buffer.h
  * @brief File containing the declaration of the copy buffer and the
  * corresponding functions.
+ * @details A copy buffer stores any amount of lines in a single contiguous
+ * block, so yanking many lines allocates only once and the block can be
+ * spliced into the rows at once.
  */
 
 #ifndef YATE_COPY_BUFFER_H_
 #define YATE_COPY_BUFFER_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 /// Copy buffer
 typedef struct {
-    /// The underlying character buffer
+    /// The underlying character buffer, every line is followed by a null byte
     char * buffer;
-    /// The length of the character buffer
+    /// The length of the character buffer, including the null bytes
     size_t length;
+    /// The lengths of the lines, without the null bytes
+    uint32_t * lineLengths;
+    /// The amount of lines that are stored
+    uint32_t lineCount;
+    /// The amount of bytes of the character buffer that are reserved
+    size_t capacity;
+    /// The amount of lines that are reserved
+    uint32_t lineCapacity;
 } copy_buffer_t;
 
+/// @brief Appends a line to a copy buffer, the room for it must have been
+/// reserved
+/// @param buffer The copy buffer where the line is appended
+/// @param str The characters of the line
+/// @param length The length of the line
+void copy_buffer_append_line(copy_buffer_t * buffer, char const * str, uint32_t length);
+
 /// @brief Frees the copy buffer
 /// @param buffer the copy buffer that is freed
 void copy_buffer_free(copy_buffer_t * buffer);
@@ -41,10 +60,19 @@ void copy_buffer_free(copy_buffer_t * buffer);
 /// @param buffer The copy buffer that is initialized
 void copy_buffer_init(copy_buffer_t * buffer);
 
+/// @brief Replaces the contents of a copy buffer with room for new lines
+/// @param buffer The copy buffer that is reset
+/// @param length The total length of the new lines, without line breaks
+/// @param lineCount The amount of new lines
+/// @return true if the room was reserved, false if no memory was available -
+/// the previous contents are kept in that case
+bool copy_buffer_reset(copy_buffer_t * buffer, size_t length, uint32_t lineCount);
+
 /// @brief Writes a string to an copy buffer
 /// @param buffer The buffer where the string is writen to
 /// @param str The string that is appended
 /// @param length The length of the string that is writen to the buffer
+/// @details The string replaces the contents of the buffer as a single line
 void copy_buffer_write(copy_buffer_t * buffer, char const * str, uint32_t length);
 
 #endif
@@ -18,12 +18,18 @@
  * @brief File containing the implementation of the editor functionality.
  */
 
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+#define _GNU_SOURCE
+
 #include "editor.h"
 
 #include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -31,14 +37,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "append_buffer.h"
+#include "column_map.h"
 #include "copy_buffer.h"
+#include "event_loop.h"
+#include "frame_cache.h"
+#include "highlight_runs.h"
+#include "lexer.h"
 #include "project_config.h"
+#include "row_arena.h"
+#include "row_buffer.h"
+#include "save_job.h"
+#include "search_index.h"
 #include "syntax.h"
 
 /// To quit with unsaved changes the quit command must be entered three times
@@ -47,66 +71,342 @@
 /// Control Key-Combination inputs (e.g. Ctrl-V)
 #define CTRL_KEY(k) ((k)&0x1f)
 
-/// Models a single line that is rendered by the editor
+/// Amount of registers lines are yanked to - the unnamed register, followed by
+/// the registers a to z
+#define REGISTER_COUNT (27)
+
+/// Minimum amount of rows that are scanned by a single thread, when the
+/// multiline comment state of a file is determined in parallel
+#define PARALLEL_SCAN_MINIMUM_CHUNK_SIZE (4096)
+
+/// Maximum amount of threads that determine the multiline comment state of a
+/// file in parallel
+#define PARALLEL_SCAN_MAXIMUM_THREADS (64)
+
+/// Minimum amount of bytes of a file, that are split into rows by a single
+/// thread, when the file is loaded in parallel
+#define PARALLEL_LOAD_MINIMUM_CHUNK_SIZE (1 << 22)
+
+/// Minimum amount of matches that are replaced by a single thread, when all
+/// matches of a query are replaced in parallel
+#define PARALLEL_REPLACE_MINIMUM_CHUNK_SIZE (16384)
+
+/// Maximum amount of threads that split a file into rows or replace matches in
+/// parallel
+#define PARALLEL_MAXIMUM_THREADS (64)
+
+/// Maximum amount of matches that are replaced at once, the progress is shown
+/// after every batch
+#define REPLACE_BATCH_SIZE (1 << 20)
+
+/// Amount of bytes that are read at once, when a file is read as a stream
+#define STREAM_READ_SIZE (1 << 16)
+
+/// Amount of characters before and after a modification of a row, whose syntax
+/// highlighting is expanded when the modification is highlighted - the tests
+/// use a smaller margin
+#ifndef PATCH_HIGHLIGHT_MARGIN
+#define PATCH_HIGHLIGHT_MARGIN (4096)
+#endif
+
+/// Maximum amount of bytes that are read from the terminal at once
+#define INPUT_BUFFER_SIZE (4096)
+
+/// Amount of milliseconds the editor waits for the rest of the pasted text,
+/// before the text that arrived is inserted
+#define PASTE_TIMEOUT (1000)
+
+/// Maximum amount of reads in a row that return none of the pasted text, reads
+/// return right away once the input was closed
+#define PASTE_MAXIMUM_EMPTY_READS (64)
+
+/// Minimum amount of milliseconds between two frames, input that arrives in the
+/// meantime is processed before the next frame is drawn
+#define FRAME_INTERVAL (16)
+
+/// Minimum amount of bytes of consecutive unmodified rows, that are copied from
+/// the opened file instead of being written when the file is saved
+#define SAVE_COPY_MINIMUM_SIZE (1 << 16)
+
+/// Amount of milliseconds between two checks whether a save in the background
+/// is completed
+#define SAVE_POLL_INTERVAL (50)
+
+/// Amount of milliseconds between two checks whether lines were appended to
+/// the followed files
+#define FOLLOW_POLL_INTERVAL (250)
+
+/// Maximum amount of bytes that are read from a followed file at once
+#define FOLLOW_READ_SIZE (65536)
+
+/// Maximum amount of rows of the output of an executed program, the oldest rows
+/// are dropped once it is exceeded
+#define EXECUTE_MAXIMUM_ROWS (10000)
+
+/// Maximum amount of bytes of output that are read from an executed program,
+/// before the input of the terminal is processed again
+#define EXECUTE_MAXIMUM_READ (1 << 20)
+
+/// Measurements of the work that was done for a single frame
 typedef struct {
-    /// Index of the editor row
-    uint32_t index;
-    /// The amount of characters stored in the underlying character buffer
-    uint32_t size;
-    /// The amount of characters stored in the render buffer, that was created
-    /// with the underlying character buffer
-    uint32_t renderSize;
-    /// The underlying character buffer
-    char * chars;
-    /// The render buffer, that was created with the underlying character buffer
-    char * render;
-    /// Pointer to the words that are highlighted
-    unsigned char * highLight;
-    /// Determines whether the row is part of a multiline comment
-    bool hightLightOpenComment;
-} editor_row_t;
+    /// Nanoseconds that were spent drawing the frame
+    uint64_t renderTime;
+    /// Nanoseconds that were spent highlighting rows since the previous frame
+    uint64_t highlightTime;
+    /// The amount of rows that were highlighted since the previous frame
+    uint32_t rowsHighlighted;
+    /// The amount of bytes that were written to the terminal for the frame
+    size_t bytesWritten;
+    /// The resident memory of the editor in bytes, after the frame was drawn
+    size_t residentMemory;
+} editor_frame_statistics_t;
 
-/// Models the current state of the editor
+/// A file that is opened by the editor, its rows, highlighting and cursor stay
+/// resident while other files are displayed
 typedef struct {
     /// X-coordinate of the curser in the underlying character buffer
     uint32_t cursorCurrentX;
     /// Y-coordinate of the curser in the underlying character buffer
     uint32_t cursorCurrentY;
-    /// X-coordinate in the render buffer
+    /// Column where the cursor is displayed, before the row is scrolled
+    /// horizontally
     uint32_t renderX;
     /// Row offset - used for vertical scrolling
     uint32_t rowOffset;
     /// Column offset - used for horizontal scrolling
     uint32_t columnOffset;
-    /// Amount of rows that are rendered on the screen
-    uint32_t screenRows;
-    /// Amount of columns that is rendered on the screen
-    uint32_t screenColumns;
     /// Amount of rows for the oppened buffer
     uint32_t numberOfRows;
-    /// Pointer to the rows of opened the buffer
-    editor_row_t * editorRows;
+    /// The rows of the opened buffer
+    row_buffer_t editorRows;
+    /// Rows before this index have an up to date multiline comment state
+    uint32_t syntaxValidRows;
+    /// Determines whether the multiline comment state of the opened file is
+    /// determined in parallel, after the first frame was drawn
+    bool syntaxScanPending;
+    /// Rows from syntaxValidRows up to this index were highlighted based on
+    /// the state of their predecessor. Once the row at syntaxValidRows ends in
+    /// the same state as before, all of them are up to date again
+    uint32_t syntaxConsistentRows;
+    /// The memory mapped file, rows that were not modified point into it
+    char * mapping;
+    /// The length of the memory mapped file
+    size_t mappingLength;
+    /// File descriptor of the memory mapped file, unmodified rows are copied
+    /// from it when the file is saved - -1 if no file is mapped
+    int mappingFileDescriptor;
+    /// Stores the rows that were read from a file, that could not be mapped
+    row_arena_t rowArena;
     /// Used to track unsafed modifications
     bool unsavedChanges;
-    /// The name of the file, that is currently opened
+    /// The name of the opened file - NULL if the buffer was not opened from a
+    /// file
     char * fileName;
+    /// Pointer to the syntax configurations of the opened file
+    editor_syntax_t * syntax;
+    /// The lexer that was compiled from the syntax configurations
+    lexer_t lexer;
+    /// Writes the rows to the disk in the background
+    save_job_t saveJob;
+    /// File descriptor of the file, whose appended lines are added to the rows
+    /// - -1 if the file is not followed
+    int followFileDescriptor;
+    /// Offset in the followed file, up to which the file was read
+    off_t followOffset;
+    /// Maximum amount of rows of the followed file, the oldest rows are dropped
+    /// once it is exceeded - 0 if all rows are kept
+    uint32_t followMaximumRows;
+    /// Determines whether the last row of the followed file was read before its
+    /// line was terminated
+    bool followPartialRow;
+    /// The row where the range of rows starts, that is yanked or deleted next
+    uint32_t markRow;
+    /// Determines whether a range of rows is marked
+    bool marked;
+    /// The interpreter that executes the program, whose output is added to the
+    /// rows - NULL if the buffer does not contain the output of a program
+    char const * executeProgram;
+    /// The process of the executed program - 0 once it exited
+    pid_t executeProcess;
+    /// Read end of the pipe the output of the executed program is read from -
+    /// -1 once the output ended
+    int executeFileDescriptor;
+    /// The wait status of the executed program, once it exited
+    int executeStatus;
+} editor_buffer_t;
+
+/// Models the current state of the editor
+typedef struct {
+    /// The file that is currently displayed
+    editor_buffer_t * current;
+    /// The files that are opened by the editor, in the order they were opened
+    editor_buffer_t ** buffers;
+    /// The amount of opened files
+    uint32_t bufferCount;
+    /// Amount of rows that are rendered on the screen
+    uint32_t screenRows;
+    /// Amount of columns that is rendered on the screen
+    uint32_t screenColumns;
+    /// The highlight group of every character of the row that is currently
+    /// highlighted, before it is compressed to runs
+    unsigned char * highLightColumns;
+    /// The amount of characters that fit into highLightColumns
+    uint32_t highLightColumnsCapacity;
     /// The status message that is diplayed under status bar
     char statusMessage[240];
-    /// Timestamp of the last message
-    time_t statusMessageTimeStamp;
-    /// Pointer to the syntax configurations of the editor
-    editor_syntax_t * syntax;
+    /// Timestamp of the last message in milliseconds
+    uint64_t statusMessageTimeStamp;
     /// Used to store the original state of the terminal
     struct termios originalTermios;
-    /// The copy buffer of the editor - used to store yanked characters
-    copy_buffer_t copyBuffer;
+    /// The registers of the editor - used to store yanked lines
+    copy_buffer_t registers[REGISTER_COUNT];
+    /// The register that is used by the next yank or paste
+    uint32_t selectedRegister;
     /// Amount of times the editor must be quit by the user if there are some
     /// unsaved changes
     uint8_t quitTimes;
     /// Configuration that was read by the configuration reader
     configuration_reader_result_t * config;
+    /// Buffer the frames are rendered to - it is reset instead of freed after
+    /// every frame, so no memory needs to be allocated once it has grown
+    append_buffer_t frameBuffer;
+    /// Buffer a single line of a frame is rendered to, before it is compared
+    /// with the last frame
+    append_buffer_t lineBuffer;
+    /// Hashes of the lines that were sent to the terminal in the last frame
+    frame_cache_t frameCache;
+    /// Row offset of the rows that were sent to the terminal in the last frame
+    uint32_t drawnRowOffset;
+    /// Column offset of the rows that were sent to the terminal in the last
+    /// frame
+    uint32_t drawnColumnOffset;
+    /// The amount of bytes that were written to the terminal in the last frame
+    size_t frameBytesWritten;
+    /// Matches of the query that is currently searched for, they are
+    /// highlighted while the search prompt is active
+    search_index_t searchIndex;
+    /// Input that was read from the terminal, but not processed yet
+    char input[INPUT_BUFFER_SIZE];
+    /// Index of the next byte in the input, that is processed
+    uint32_t inputStart;
+    /// Amount of bytes stored in the input
+    uint32_t inputEnd;
+    /// Waits for input, while the timers and signals of the editor are handled
+    event_loop_t eventLoop;
+    /// Expires once the status message is hidden
+    int32_t statusMessageTimer;
+    /// Expires once it is checked again whether a save in progress is completed
+    int32_t saveTimer;
+    /// Expires once the followed files are checked for appended lines again and
+    /// the output of executed programs, that was not watched, is watched again
+    int32_t followTimer;
+    /// Timestamp of the last frame in milliseconds
+    uint64_t lastFrameTime;
+    /// Determines whether the screen needs to be redrawn, although no input
+    /// arrived
+    bool redrawPending;
+    /// File descriptor the input of the terminal is read from
+    int inputFileDescriptor;
+    /// File descriptor the frames are written to
+    int outputFileDescriptor;
+    /// Called after every frame, that was drawn - NULL if not set
+    editor_frame_callback_t frameCallback;
+    /// Determines whether the measurements of the last frame are shown in the
+    /// status bar
+    bool hudVisible;
+    /// File the measurements of every keypress and frame are logged to - NULL
+    /// if no trace is written
+    FILE * traceFile;
+    /// Point in time the trace was started in nanoseconds
+    uint64_t traceStart;
+    /// Measurements of the frame that is currently prepared
+    editor_frame_statistics_t frameStatistics;
+    /// Measurements of the last frame that was drawn
+    editor_frame_statistics_t lastFrameStatistics;
+    /// The number of the frame that is currently drawn, rows store the number of
+    /// the frame they were used last
+    uint32_t frameNumber;
+    /// Estimate of the bytes of the render buffers, the syntax highlighting and
+    /// the column maps of the rows of all opened files. It is determined exactly
+    /// once it exceeds the memory budget
+    size_t derivedMemory;
 } editor_config_t;
 
+/// Range of rows that's multiline comment state is determined by a single
+/// worker thread
+typedef struct {
+    /// Index of the first row of the chunk
+    uint32_t begin;
+    /// Index of the first row after the chunk
+    uint32_t end;
+    /// The state at the end of each row of the chunk. Bit 0 is the state if the
+    /// chunk starts outside of a multiline comment, bit 1 the state if it starts
+    /// inside of one
+    uint8_t * states;
+} syntax_scan_chunk_t;
+
+/// Range of the memory mapped file, whose lines are split into rows by a single
+/// worker thread
+typedef struct {
+    /// The memory mapped file
+    char * mapping;
+    /// The size of the file
+    size_t fileSize;
+    /// Offset of the first byte of the range
+    size_t begin;
+    /// Offset of the first byte after the range
+    size_t end;
+    /// The amount of lines that start in the range
+    size_t rowCount;
+    /// The rows of the lines that start in the range, once they were counted
+    editor_row_t * rows;
+} line_split_chunk_t;
+
+/// A row whose matches were replaced by a worker thread
+typedef struct {
+    /// The index of the row
+    uint32_t row;
+    /// The amount of characters of the new character buffer
+    uint32_t size;
+    /// The new underlying character buffer of the row
+    char * chars;
+} replaced_row_t;
+
+/// Range of the matches of a query, that are replaced by a single worker thread
+typedef struct {
+    /// The matches of the query, ordered by their position in the file
+    search_match_t const * matches;
+    /// Index of the first match of the range
+    uint32_t begin;
+    /// Index of the first match after the range, a range never ends within a row
+    uint32_t end;
+    /// The query that is replaced
+    char const * query;
+    /// The length of the query
+    uint32_t queryLength;
+    /// The text the query is replaced with
+    char const * replacement;
+    /// The length of the replacement
+    uint32_t replacementLength;
+    /// The rows of the range with their new character buffers - NULL if no
+    /// memory was available
+    replaced_row_t * rows;
+    /// The amount of rows of the range
+    uint32_t rowCount;
+    /// The amount of matches that were replaced, matches that overlap a
+    /// replaced match are skipped
+    uint32_t replaced;
+} replace_chunk_t;
+
+/// The memory of the data of a row, that is derived from its underlying
+/// character buffer, and the frame the row was used last
+typedef struct {
+    /// The frame the row was used last
+    uint32_t lastUse;
+    /// The amount of bytes that are released, once the row is released
+    size_t size;
+} editor_row_usage_t;
+
 /// Special control characters
 enum editorKey {
     /// The backspace key
@@ -129,6 +429,10 @@ enum editorKey {
     PAGE_UP,
     /// Page up key - used for scrolling down
     PAGE_DOWN,
+    /// Marks the start of text that is pasted into the terminal
+    PASTE_START,
+    /// Marks the end of text that is pasted into the terminal
+    PASTE_END,
 };
 
 /// Used to store the state of the terminal when Yate was invoked, so we can
@@ -141,42 +445,111 @@ editor_config_t editorConfig;
 static inline void editor_die(char const *);
 static inline void editor_disable_raw_mode();
 static void editor_delete_character();
+static void editor_delete_lines();
+static editor_buffer_t * editor_add_buffer();
+static uint32_t editor_append_followed_text(char const *, size_t);
+static void editor_append_loaded_row(char *, size_t, bool);
+static uint32_t editor_buffer_index(editor_buffer_t const *);
+static void editor_close_buffer();
+static int editor_compare_row_usage(void const *, void const *);
+static void editor_complete_frame_statistics(uint64_t, size_t);
+static size_t editor_count_line_breaks(char const *, size_t);
+static void * editor_count_lines_chunk(void *);
 static void editor_delete_row(uint32_t);
+static void editor_delete_rows(uint32_t, uint32_t);
 static void editor_draw_message_bar(append_buffer_t *);
-static void editor_draw_rows(append_buffer_t *);
+static void editor_draw_row(append_buffer_t *, uint32_t);
+static void editor_draw_scroll(append_buffer_t *);
 static void editor_draw_status_bar(append_buffer_t *);
+static void editor_enforce_memory_budget();
 static void editor_execute();
+static void editor_expire_status_message();
 static void editor_find();
+static editor_buffer_t * editor_find_buffer(char const *);
 static void editor_find_callback(char *, uint32_t);
+static save_job_copy_t * editor_find_unmodified_ranges(uint32_t *);
+static void editor_finish_program(editor_buffer_t *);
+static bool editor_finish_save(bool);
 static inline void editor_free_row(editor_row_t *);
+static void editor_free_buffer(editor_buffer_t *);
+static void editor_follow_rows(uint32_t, bool, bool);
+static off_t editor_follow_start(int, off_t, uint32_t);
+static void editor_free_rows();
+static inline editor_row_t * editor_get_row(uint32_t);
 static int32_t editor_get_cursor_position(uint32_t *, uint32_t *);
 static int32_t editor_get_window_size(uint32_t *, uint32_t *);
+static inline bool editor_has_multiline_comments();
+static bool editor_highlight_columns(editor_row_t *, unsigned char *, bool);
+static bool editor_highlight_range(editor_row_t *, unsigned char *, uint32_t, bool, uint32_t);
+static bool editor_highlight_row(editor_row_t *, bool);
+static inline void editor_init_row(editor_row_t *, char *, size_t, bool);
 static void editor_insert_character(uint32_t);
 static void editor_insert_newline();
 static void editor_insert_row(uint32_t, char *, size_t);
-static inline bool editor_is_separator(uint32_t);
+static void editor_insert_text(char const *, size_t);
+static void editor_insert_unrendered_row(uint32_t, char *, size_t, bool);
+static void editor_invalidate_syntax(uint32_t);
+static inline bool editor_is_profiling();
+static bool editor_load_mapped(int, size_t);
+static void editor_load_stream(int);
+static void editor_mark_line();
+static bool editor_marked_rows(uint32_t *, uint32_t *);
 static void editor_move_cursor(uint32_t);
 static void editor_open_file();
 static void editor_open_file_callback(char *, uint32_t);
-static inline void editor_paste_line();
-static char * editor_prompt(char *, void (*)(char *, uint32_t));
+static void editor_paste_lines();
+static void editor_paste_text();
+static editor_row_t * editor_prepare_row(uint32_t);
+static void editor_propagate_syntax(uint32_t);
+static uint64_t editor_now();
+static char * editor_prompt(char *, void (*)(char *, uint32_t), bool);
+static void editor_poll_follow();
+static void editor_poll_save();
 static void editor_quit();
+static bool editor_read_byte(char *);
+static bool editor_read_followed_file(bool);
+static void editor_record_highlight(uint64_t);
 static uint32_t editor_read_key();
+static void editor_read_program_output();
+static void editor_reap_programs();
+static void editor_replace_all();
+static void * editor_replace_chunk(void *);
+static unsigned char * editor_reserve_highlight_columns(uint32_t);
+static inline void editor_release_row(editor_row_t *);
+static void editor_render_row(editor_row_t *);
+static void editor_resize();
+static size_t editor_resident_memory();
 static void editor_render_welcome_screen_row(append_buffer_t *, uint32_t);
-static void editor_row_append_string(editor_row_t *, char *, size_t);
+static void editor_row_append_string(uint32_t, char *, size_t);
+static void editor_row_append_unrendered(editor_row_t *, char const *, size_t);
+static column_map_t const * editor_row_column_map(editor_row_t *);
 static uint32_t editor_row_cx_to_rx(editor_row_t *, uint32_t);
-static void editor_row_delete_character(editor_row_t *, uint32_t);
-static void editor_row_insert_character(editor_row_t *, uint32_t, uint32_t);
-static uint32_t editor_row_rx_to_cx(editor_row_t *, uint32_t);
-static char * editor_rows_to_string(uint32_t *);
+static void editor_row_delete_character(uint32_t, uint32_t);
+static inline size_t editor_row_derived_size(editor_row_t const *);
+static void editor_row_detach(editor_row_t *);
+static column_map_position_t editor_row_find_column(editor_row_t *, uint32_t);
+static column_map_position_t editor_row_find_character(editor_row_t *, uint32_t);
+static void editor_row_insert_character(uint32_t, uint32_t, uint32_t);
+static bool editor_row_patch(uint32_t, uint32_t, int32_t, char);
+static void editor_run_parallel(void * (*)(void *), void *, size_t, uint32_t);
 static void editor_save();
+static void editor_scan_syntax(uint32_t);
+static void * editor_scan_syntax_chunk(void *);
+static void editor_scan_syntax_parallel();
 static void editor_scroll();
+static void editor_select_register();
 static void editor_select_syntax_highlight();
 static void editor_set_status_message(char const *, ...);
 static inline void editor_show_help();
-static void editor_update_row(editor_row_t *);
-static void editor_update_syntax(editor_row_t *);
-static inline void editor_yank_line();
+static void * editor_split_lines_chunk(void *);
+static void editor_switch_buffer(editor_buffer_t *);
+static inline void editor_toggle_hud();
+static void editor_trace(char const *, ...);
+static bool editor_wait_for_input(int32_t);
+static void editor_unmap_file();
+static void editor_update_row(uint32_t);
+static void editor_update_syntax(uint32_t);
+static bool editor_yank_lines(uint32_t *, uint32_t *);
 
 /// @brief Enables raw mode
 /// @details By default the terminal starts in canonical mode. Iput is only sent
@@ -211,109 +584,234 @@ void editor_enable_raw_mode() {
     if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == -1) {
         editor_die("tcsetattr");
     }
+    // Enables bracketed paste mode, the terminal marks the start and the end of pasted text
+    write(STDOUT_FILENO, "\x1b[?2004h", 8);
+}
+
+void editor_follow(char const * filePath, uint32_t maximumRows) {
+    editor_buffer_t * opened = editor_find_buffer(filePath);
+    if (opened) {
+        editor_switch_buffer(opened);
+        return;
+    }
+    int fileDescriptor = open(filePath, O_RDONLY);
+    if (fileDescriptor == -1) {
+        editor_set_status_message("File under the path %s not found", filePath);
+        return;
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) == -1 || !S_ISREG(fileStatus.st_mode)) {
+        close(fileDescriptor);
+        editor_set_status_message("Only regular files can be followed, %s is not one", filePath);
+        return;
+    }
+    editor_buffer_t * current = editorConfig.current;
+    if (current->fileName || current->numberOfRows || current->unsavedChanges) {
+        editor_switch_buffer(editor_add_buffer());
+        current = editorConfig.current;
+    }
+    free(current->fileName);
+    current->fileName = strdup(filePath);
+    editor_select_syntax_highlight();
+    // The file is not memory mapped, the mapping would point past the end of the file once it is truncated
+    current->followFileDescriptor = fileDescriptor;
+    current->followMaximumRows = maximumRows;
+    current->followOffset = editor_follow_start(fileDescriptor, fileStatus.st_size, maximumRows);
+    current->followPartialRow = false;
+    editor_read_followed_file(true);
+    current->syntaxScanPending = true;
+
+    current->unsavedChanges = false;
+    event_loop_start_timer(&editorConfig.eventLoop, editorConfig.followTimer, FOLLOW_POLL_INTERVAL);
+}
+
+bool editor_has_pending_input() {
+    if (editorConfig.inputStart < editorConfig.inputEnd) {
+        return true;
+    }
+    // Input that arrives before the next frame is due is processed first, so bursts are drawn as one frame
+    uint64_t now = event_loop_now();
+    uint64_t nextFrameTime = editorConfig.lastFrameTime + FRAME_INTERVAL;
+    return editor_wait_for_input(nextFrameTime > now ? (int32_t)(nextFrameTime - now) : 0);
 }
 
 void editor_initialize(configuration_reader_result_t * config) {
-    editorConfig.cursorCurrentX = editorConfig.renderX = editorConfig.cursorCurrentY = editorConfig.rowOffset =
-        editorConfig.columnOffset = editorConfig.numberOfRows = editorConfig.statusMessageTimeStamp = 0;
-    editorConfig.unsavedChanges = false;
-    editorConfig.quitTimes = QUIT_TIMES;
-    editorConfig.editorRows = NULL;
-    editorConfig.fileName = NULL;
-    editorConfig.statusMessage[0] = '\0';
-    editorConfig.syntax = NULL;
-    if (editor_get_window_size(&editorConfig.screenRows, &editorConfig.screenColumns) == -1) {
+    uint32_t rows, columns;
+    if (editor_get_window_size(&rows, &columns) == -1) {
         // Could not determine window size
         editor_die("editor_get_window_size");
     }
+    editor_initialize_with_terminal(config, STDIN_FILENO, STDOUT_FILENO, rows, columns);
+    // The layout is adjusted once the terminal is resized
+    if (!event_loop_handle_signal(&editorConfig.eventLoop, SIGWINCH, editor_resize)) {
+        editor_die("event_loop_handle_signal");
+    }
+}
 
+void editor_initialize_with_terminal(configuration_reader_result_t * config, int inputFileDescriptor,
+                                     int outputFileDescriptor, uint32_t rows, uint32_t columns) {
+    editorConfig.buffers = NULL;
+    editorConfig.bufferCount = 0;
+    editorConfig.current = editor_add_buffer();
+    editorConfig.statusMessageTimeStamp = 0;
+    editorConfig.quitTimes = QUIT_TIMES;
+    editorConfig.highLightColumns = NULL;
+    editorConfig.highLightColumnsCapacity = 0;
+    editorConfig.statusMessage[0] = '\0';
+    editorConfig.inputFileDescriptor = inputFileDescriptor;
+    editorConfig.outputFileDescriptor = outputFileDescriptor;
+    editorConfig.frameCallback = NULL;
+    editorConfig.hudVisible = false;
+    editorConfig.traceFile = NULL;
+    editorConfig.traceStart = 0;
+    memset(&editorConfig.frameStatistics, 0, sizeof(editor_frame_statistics_t));
+    memset(&editorConfig.lastFrameStatistics, 0, sizeof(editor_frame_statistics_t));
+    editorConfig.frameNumber = 0;
+    editorConfig.derivedMemory = 0;
     // Make room for status bar and message bar
-    editorConfig.screenRows -= 2;
+    editorConfig.screenRows = rows > 2 ? rows - 2 : 1;
+    editorConfig.screenColumns = columns;
     editorConfig.config = config;
-    copy_buffer_init(&editorConfig.copyBuffer);
+    for (uint32_t i = 0; i < REGISTER_COUNT; i++) {
+        copy_buffer_init(&editorConfig.registers[i]);
+    }
+    editorConfig.selectedRegister = 0;
+    syntax_compile_keyword_tables();
+    syntax_compile_color_sequences(config->colorMode);
+    append_buffer_free(&editorConfig.frameBuffer);
+    append_buffer_free(&editorConfig.lineBuffer);
+    frame_cache_free(&editorConfig.frameCache);
+    editorConfig.frameBytesWritten = 0;
+    search_index_free(&editorConfig.searchIndex);
+    editorConfig.inputStart = editorConfig.inputEnd = 0;
+    if (!event_loop_init(&editorConfig.eventLoop)) {
+        editor_die("event_loop_init");
+    }
+    editorConfig.statusMessageTimer = event_loop_add_timer(&editorConfig.eventLoop, editor_expire_status_message);
+    editorConfig.saveTimer = event_loop_add_timer(&editorConfig.eventLoop, editor_poll_save);
+    editorConfig.followTimer = event_loop_add_timer(&editorConfig.eventLoop, editor_poll_follow);
+    // The exit status of executed programs is added to their output
+    if (!event_loop_handle_signal(&editorConfig.eventLoop, SIGCHLD, editor_reap_programs)) {
+        editor_die("event_loop_handle_signal");
+    }
+    editorConfig.lastFrameTime = 0;
+    editorConfig.redrawPending = false;
 }
 
 void editor_open(char const * filePath) {
-    FILE * filePointer = fopen(filePath, "r");
-    if (!filePointer) {
+    // Files that were opened already are displayed again, instead of being loaded another time
+    editor_buffer_t * opened = editor_find_buffer(filePath);
+    if (opened) {
+        editor_switch_buffer(opened);
+        return;
+    }
+    int fileDescriptor = open(filePath, O_RDONLY);
+    if (fileDescriptor == -1) {
         editor_set_status_message("File under the path %s not found", filePath);
         return;
     }
-    char * line = NULL;
-    size_t lineCap = 0;
-    ssize_t lineLength;
-    while ((lineLength = getline(&line, &lineCap, filePointer)) != -1) {
-        while (lineLength > 0 && (line[lineLength - 1] == '\n' || line[lineLength - 1] == '\r')) {
-            lineLength--;
-        }
-        editor_insert_row(editorConfig.numberOfRows, line, lineLength);
+    // The empty buffer the editor was started with is reused
+    editor_buffer_t * current = editorConfig.current;
+    if (current->fileName || current->numberOfRows || current->unsavedChanges) {
+        editor_switch_buffer(editor_add_buffer());
+    }
+    // Regular files are memory mapped, everything else (e.g. pipes) is read line by line
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) == -1 || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size == 0 ||
+        !editor_load_mapped(fileDescriptor, fileStatus.st_size)) {
+        editor_load_stream(fileDescriptor);
+    }
+    // The memory mapped file stays open, it is the source of the unmodified rows once the file is saved
+    if (editorConfig.current->mappingFileDescriptor != fileDescriptor) {
+        close(fileDescriptor);
     }
-    free(line);
-    fclose(filePointer);
 
-    free(editorConfig.fileName);
-    editorConfig.fileName = strdup(filePath);
+    free(editorConfig.current->fileName);
+    editorConfig.current->fileName = strdup(filePath);
     // Selects syntax highlighting configuration based on file extension
     editor_select_syntax_highlight();
+    // The rows below the viewport are scanned once the first frame is visible
+    editorConfig.current->syntaxScanPending = true;
 
-    editorConfig.unsavedChanges = false;
-    editorConfig.cursorCurrentX = 0;
+    editorConfig.current->unsavedChanges = false;
+    editorConfig.current->cursorCurrentX = 0;
 }
 
 void editor_process_keypress() {
 
     uint32_t c = editor_read_key();
+    uint64_t start = editorConfig.traceFile ? editor_now() : 0;
     switch (c) {
     case '\r':
         editor_insert_newline();
         break;
 
     case HOME_KEY:
-        editorConfig.cursorCurrentX = 0;
+        editorConfig.current->cursorCurrentX = 0;
         break;
     case END_KEY:
-        if (editorConfig.cursorCurrentY < editorConfig.numberOfRows) {
-            editorConfig.cursorCurrentX = editorConfig.editorRows[editorConfig.cursorCurrentY].size;
+        if (editorConfig.current->cursorCurrentY < editorConfig.current->numberOfRows) {
+            editorConfig.current->cursorCurrentX = editor_get_row(editorConfig.current->cursorCurrentY)->size;
         }
         break;
 
-    // Deletes a signle line and stores it in the copy buffer of the editor so it
-    // can be pasted later
+    // Deletes a signle line or the marked lines and stores them in a register of
+    // the editor so they can be pasted later
     case CTRL_KEY('d'):
-        editor_yank_line();
-        editor_delete_row(editorConfig.cursorCurrentY);
+        editor_delete_lines();
         break;
         // Find word in file
     case CTRL_KEY('f'):
         editor_find();
         break;
+    // Replaces all occurences of a word in the file
+    case CTRL_KEY('g'):
+        editor_replace_all();
+        break;
     // Show help as status message
     case CTRL_KEY('h'):
         editor_show_help();
         break;
+    // Marks the start of a range of lines, that are yanked or deleted at once
+    case CTRL_KEY('k'):
+        editor_mark_line();
+        break;
+    // Displays the next opened file
+    case CTRL_KEY('n'):
+        editor_switch_buffer(editorConfig.buffers[(editor_buffer_index(editorConfig.current) + 1) %
+                                                  editorConfig.bufferCount]);
+        break;
     // Opens another file in the editor
     case CTRL_KEY('o'):
         editor_open_file();
         break;
-    // Pastes the content of the copy buffer
+    // Pastes the content of a register
     case CTRL_KEY('p'):
-        editor_paste_line();
+        editor_paste_lines();
         break;
     // Ctrl-q quits the editor
     case CTRL_KEY('q'):
         editor_quit();
         break;
+    // Selects the register for the next yank or paste
+    case CTRL_KEY('r'):
+        editor_select_register();
+        break;
     // Save file
     case CTRL_KEY('s'):
         editor_save();
         break;
+    // Closes the file that is currently displayed
+    case CTRL_KEY('w'):
+        editor_close_buffer();
+        break;
     // Executes the file that is currently opened by the editor
     case CTRL_KEY('x'):
         editor_execute();
         break;
-        // Yanks the line the cursor is currently positioned in
+        // Yanks the line the cursor is currently positioned in or the marked lines
     case CTRL_KEY('y'):
-        editor_yank_line();
+        editor_yank_lines(NULL, NULL);
         break;
 
     case BACKSPACE:
@@ -328,11 +826,11 @@ void editor_process_keypress() {
     case PAGE_DOWN:
         {
             if (c == PAGE_UP) {
-                editorConfig.cursorCurrentY = editorConfig.rowOffset;
+                editorConfig.current->cursorCurrentY = editorConfig.current->rowOffset;
             } else if (c == PAGE_DOWN) {
-                editorConfig.cursorCurrentY = editorConfig.rowOffset + editorConfig.screenRows - 1;
-                if (editorConfig.cursorCurrentY > editorConfig.numberOfRows) {
-                    editorConfig.cursorCurrentY = editorConfig.numberOfRows;
+                editorConfig.current->cursorCurrentY = editorConfig.current->rowOffset + editorConfig.screenRows - 1;
+                if (editorConfig.current->cursorCurrentY > editorConfig.current->numberOfRows) {
+                    editorConfig.current->cursorCurrentY = editorConfig.current->numberOfRows;
                 }
             }
 
@@ -351,11 +849,25 @@ void editor_process_keypress() {
         editor_move_cursor(c);
         break;
 
-    // Escape
+    // Redraws the whole screen
     case CTRL_KEY('l'):
+        frame_cache_invalidate(&editorConfig.frameCache);
+        break;
+    // Shows or hides the measurements of the last frame
+    case CTRL_KEY('t'):
+        editor_toggle_hud();
+        break;
+    // Escape
     case '\x1b':
         break;
 
+    // Text that is pasted into the terminal is inserted at once
+    case PASTE_START:
+        editor_paste_text();
+        break;
+    case PASTE_END:
+        break;
+
     default:
         editor_insert_character(c);
         break;
@@ -365,27 +877,168 @@ void editor_process_keypress() {
     if (c != CTRL_KEY('q') && editorConfig.quitTimes != QUIT_TIMES) {
         editorConfig.quitTimes = QUIT_TIMES;
     }
+    if (editorConfig.traceFile) {
+        editor_trace("key %u process_us %llu", c, (unsigned long long)(editor_now() - start) / 1000);
+    }
 }
 
 void editor_refresh_screen() {
+    uint64_t start = editor_is_profiling() ? editor_now() : 0;
+    editorConfig.frameNumber++;
     editor_scroll();
 
-    append_buffer_t buffer;
-    append_buffer_init(&buffer);
-    append_buffer_append_string(&buffer, "\x1b[?25l", 6);
-    append_buffer_append_string(&buffer, "\x1b[H", 3);
-    editor_draw_rows(&buffer);
-    editor_draw_status_bar(&buffer);
-    editor_draw_message_bar(&buffer);
-
+    append_buffer_t * buffer = &editorConfig.frameBuffer;
+    append_buffer_t * line = &editorConfig.lineBuffer;
+    append_buffer_reset(buffer);
+    // The rows are followed by the status bar and the message bar
+    uint32_t lineCount = editorConfig.screenRows + 2;
+    frame_cache_resize(&editorConfig.frameCache, lineCount);
+    editor_draw_scroll(buffer);
     char buf[32];
-    snprintf(buf, sizeof(buf), "\x1b[%d;%dH", (editorConfig.cursorCurrentY - editorConfig.rowOffset) + 1,
-             (editorConfig.renderX - editorConfig.columnOffset) + 1);
-    append_buffer_append_string(&buffer, buf, strlen(buf));
+    for (uint32_t y = 0; y < lineCount; y++) {
+        append_buffer_reset(line);
+        if (y < editorConfig.screenRows) {
+            editor_draw_row(line, y);
+        } else if (y == editorConfig.screenRows) {
+            editor_draw_status_bar(line);
+        } else {
+            editor_draw_message_bar(line);
+        }
+        // Only lines that differ from the last frame are sent to the terminal
+        if (frame_cache_update_line(&editorConfig.frameCache, y, line->buffer, line->length)) {
+            if (!buffer->length) {
+                append_buffer_append_string(buffer, "\x1b[?25l", 6);
+            }
+            int positionLength = snprintf(buf, sizeof(buf), "\x1b[%d;1H", y + 1);
+            append_buffer_append_string(buffer, buf, positionLength);
+            append_buffer_append_string(buffer, line->buffer, line->length);
+        }
+    }
+    frame_cache_complete_frame(&editorConfig.frameCache);
+    editorConfig.drawnRowOffset = editorConfig.current->rowOffset;
+    editorConfig.drawnColumnOffset = editorConfig.current->columnOffset;
+    bool linesChanged = buffer->length != 0;
+
+    snprintf(buf, sizeof(buf), "\x1b[%d;%dH",
+             (editorConfig.current->cursorCurrentY - editorConfig.current->rowOffset) + 1,
+             (editorConfig.current->renderX - editorConfig.current->columnOffset) + 1);
+    append_buffer_append_string(buffer, buf, strlen(buf));
+
+    if (linesChanged) {
+        append_buffer_append_string(buffer, "\x1b[?25h", 6);
+    }
+    write(editorConfig.outputFileDescriptor, buffer->buffer, buffer->length);
+    editorConfig.frameBytesWritten = buffer->length;
+    editorConfig.lastFrameTime = event_loop_now();
+    editorConfig.redrawPending = false;
+    if (editor_is_profiling()) {
+        editor_complete_frame_statistics(start, buffer->length);
+    }
+    if (editorConfig.frameCallback) {
+        editorConfig.frameCallback(buffer->length);
+    }
+    editor_enforce_memory_budget();
+
+    if (editorConfig.current->syntaxScanPending) {
+        editorConfig.current->syntaxScanPending = false;
+        editor_scan_syntax_parallel();
+    }
+}
+
+void editor_set_frame_callback(editor_frame_callback_t callback) {
+    editorConfig.frameCallback = callback;
+}
+
+bool editor_start_trace(char const * path) {
+    editorConfig.traceFile = fopen(path, "w");
+    if (editorConfig.traceFile == NULL) {
+        return false;
+    }
+    editorConfig.traceStart = editor_now();
+    fprintf(editorConfig.traceFile, "# time_ms key <code> process_us <n>\n"
+                                    "# time_ms frame render_us <n> highlight_us <n> rows <n> bytes <n> rss_kib <n>\n");
+    return true;
+}
 
-    append_buffer_append_string(&buffer, "\x1b[?25h", 6);
-    write(STDOUT_FILENO, buffer.buffer, buffer.length);
-    append_buffer_free(&buffer);
+void editor_wait_for_save() {
+    editor_buffer_t * displayed = editorConfig.current;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        // The save is completed through the displayed buffer
+        editorConfig.current = editorConfig.buffers[i];
+        editor_finish_save(true);
+    }
+    editorConfig.current = displayed;
+}
+
+/// @brief Compares the usage of two rows by the frame they were used last
+/// @param first The usage of the first row
+/// @param second The usage of the second row
+/// @return A negative value if the first row was used before the second row, a
+/// positive value if it was used after it and 0 if both were used in the same
+/// frame
+static int editor_compare_row_usage(void const * first, void const * second) {
+    uint32_t firstUse = ((editor_row_usage_t const *)first)->lastUse;
+    uint32_t secondUse = ((editor_row_usage_t const *)second)->lastUse;
+    return firstUse < secondUse ? -1 : firstUse > secondUse;
+}
+
+/// @brief Completes the measurements of a frame, they are shown in the status
+/// bar with the next frame and written to the trace
+/// @param start Point in time the frame was started in nanoseconds
+/// @param bytesWritten The amount of bytes that were written for the frame
+static void editor_complete_frame_statistics(uint64_t start, size_t bytesWritten) {
+    editor_frame_statistics_t * statistics = &editorConfig.frameStatistics;
+    statistics->renderTime = editor_now() - start;
+    statistics->bytesWritten = bytesWritten;
+    statistics->residentMemory = editor_resident_memory();
+    if (editorConfig.traceFile) {
+        editor_trace("frame render_us %llu highlight_us %llu rows %u bytes %zu rss_kib %zu",
+                     (unsigned long long)statistics->renderTime / 1000,
+                     (unsigned long long)statistics->highlightTime / 1000, statistics->rowsHighlighted,
+                     statistics->bytesWritten, statistics->residentMemory / 1024);
+        fflush(editorConfig.traceFile);
+    }
+    editorConfig.lastFrameStatistics = *statistics;
+    memset(statistics, 0, sizeof(editor_frame_statistics_t));
+}
+
+/// @brief Counts the line breaks in a character sequence, 16 bytes at once
+/// @param text The character sequence
+/// @param length The length of the character sequence
+/// @return The amount of line breaks
+static size_t editor_count_line_breaks(char const * text, size_t length) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i const lineBreaks = _mm_set1_epi8('\n');
+    while (i + 16 <= length) {
+        // Every byte of the sums counts up to 255 line breaks, before the bytes are added up
+        size_t blockEnd = length - i > 255 * 16 ? i + 255 * 16 : length;
+        __m128i sums = _mm_setzero_si128();
+        for (; i + 16 <= blockEnd; i += 16) {
+            __m128i block = _mm_loadu_si128((__m128i const *)&text[i]);
+            sums = _mm_sub_epi8(sums, _mm_cmpeq_epi8(block, lineBreaks));
+        }
+        __m128i total = _mm_sad_epu8(sums, _mm_setzero_si128());
+        count += (size_t)_mm_cvtsi128_si32(total) + (size_t)_mm_extract_epi16(total, 4);
+    }
+#endif
+    for (; i < length; i++) {
+        count += text[i] == '\n';
+    }
+    return count;
+}
+
+/// @brief Counts the lines that start in a range of the memory mapped file
+/// @param argument The line_split_chunk_t whose lines are counted
+/// @return NULL
+static void * editor_count_lines_chunk(void * argument) {
+    line_split_chunk_t * chunk = argument;
+    // Lines start at the beginning of the file and after every line break in front of the last byte of the range
+    size_t scanStart = chunk->begin ? chunk->begin - 1 : 0;
+    chunk->rowCount = (chunk->begin == 0 ? 1 : 0) +
+                      editor_count_line_breaks(&chunk->mapping[scanStart], chunk->end - 1 - scanStart);
+    return NULL;
 }
 
 /// @brief Emits an error message and quits the editor
@@ -400,45 +1053,218 @@ static inline void editor_die(char const * message) {
 
 /// @brief Disables raw input mode
 static inline void editor_disable_raw_mode() {
+    write(STDOUT_FILENO, "\x1b[?2004l", 8);
     if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &editorConfig.originalTermios) == -1) {
         editor_die("tcsetattr");
     }
 }
 
+/// @brief Creates an empty buffer and adds it to the opened files
+/// @return The buffer that was created
+static editor_buffer_t * editor_add_buffer() {
+    editor_buffer_t * buffer = malloc(sizeof(editor_buffer_t));
+    editor_buffer_t ** buffers =
+        realloc(editorConfig.buffers, sizeof(editor_buffer_t *) * (editorConfig.bufferCount + 1));
+    if (!buffer || !buffers) {
+        editor_die("editor_add_buffer");
+    }
+    buffer->cursorCurrentX = buffer->renderX = buffer->cursorCurrentY = buffer->rowOffset = buffer->columnOffset =
+        buffer->numberOfRows = 0;
+    row_buffer_init(&buffer->editorRows);
+    buffer->syntaxValidRows = buffer->syntaxConsistentRows = 0;
+    buffer->syntaxScanPending = false;
+    buffer->mapping = NULL;
+    buffer->mappingLength = 0;
+    buffer->mappingFileDescriptor = -1;
+    row_arena_init(&buffer->rowArena);
+    buffer->unsavedChanges = false;
+    buffer->fileName = NULL;
+    buffer->syntax = NULL;
+    lexer_compile(&buffer->lexer, NULL);
+    save_job_init(&buffer->saveJob);
+    buffer->followFileDescriptor = -1;
+    buffer->followOffset = 0;
+    buffer->followMaximumRows = 0;
+    buffer->followPartialRow = false;
+    buffer->markRow = 0;
+    buffer->marked = false;
+    buffer->executeProgram = NULL;
+    buffer->executeProcess = 0;
+    buffer->executeFileDescriptor = -1;
+    buffer->executeStatus = 0;
+    editorConfig.buffers = buffers;
+    editorConfig.buffers[editorConfig.bufferCount++] = buffer;
+    return buffer;
+}
+
+/// @brief Appends a row, that was read from a file, without rendering it
+/// @param chars The underlying character buffer of the row
+/// @param length The length of the row
+/// @param mapped Determines whether the character buffer points into the memory
+/// mapped file
+/// @details The render buffer and the syntax highlighting are created once the
+/// row is needed
+static inline void editor_append_loaded_row(char * chars, size_t length, bool mapped) {
+    editor_insert_unrendered_row(editorConfig.current->numberOfRows, chars, length, mapped);
+}
+
+/// @brief Splits text, that was appended to the followed file or that was
+/// written by the executed program of the opened buffer, into rows
+/// @param text The text that is added to the rows
+/// @param length The length of the text
+/// @return The amount of the oldest rows that were dropped, because the maximum
+/// amount of rows was exceeded
+/// @details A line that is not terminated yet is continued by the next text
+static uint32_t editor_append_followed_text(char const * text, size_t length) {
+    editor_buffer_t * buffer = editorConfig.current;
+    char const * textEnd = text + length;
+    for (char const * lineStart = text; lineStart < textEnd;) {
+        char const * lineEnd = memchr(lineStart, '\n', textEnd - lineStart);
+        size_t lineLength = (lineEnd ? lineEnd : textEnd) - lineStart;
+        editor_row_t * row;
+        if (buffer->followPartialRow) {
+            // The line of the last row was continued
+            row = editor_get_row(buffer->numberOfRows - 1);
+            editor_row_detach(row);
+            editor_release_row(row);
+            editor_row_append_unrendered(row, lineStart, lineLength);
+            editor_invalidate_syntax(buffer->numberOfRows - 1);
+        } else {
+            char * chars = malloc(lineLength + 1);
+            if (chars == NULL) {
+                editor_die("malloc");
+            }
+            memcpy(chars, lineStart, lineLength);
+            chars[lineLength] = '\0';
+            editor_insert_unrendered_row(buffer->numberOfRows, chars, lineLength, false);
+            row = editor_get_row(buffer->numberOfRows - 1);
+        }
+        if (lineEnd) {
+            while (row->size > 0 && row->chars[row->size - 1] == '\r') {
+                row->chars[--row->size] = '\0';
+            }
+        }
+        buffer->followPartialRow = !lineEnd;
+        lineStart = lineEnd ? lineEnd + 1 : textEnd;
+    }
+    // The oldest rows are dropped after every text, so the rows never exceed the maximum by much
+    uint32_t droppedRows = 0;
+    if (buffer->followMaximumRows && buffer->numberOfRows > buffer->followMaximumRows) {
+        droppedRows = buffer->numberOfRows - buffer->followMaximumRows;
+        editor_delete_rows(0, droppedRows);
+    }
+    return droppedRows;
+}
+
+/// @brief Gets the position of a buffer in the opened files
+/// @param buffer The buffer that is searched for
+/// @return The index of the buffer
+static uint32_t editor_buffer_index(editor_buffer_t const * buffer) {
+    uint32_t index = 0;
+    while (editorConfig.buffers[index] != buffer) {
+        index++;
+    }
+    return index;
+}
+
+/// @brief Closes the file that is currently displayed and displays the next
+/// opened file
+/// @details The last file is replaced by an empty buffer
+static void editor_close_buffer() {
+    if (editorConfig.current->unsavedChanges) {
+        editor_set_status_message("Can not close a file, that has some unsaved changes");
+        return;
+    }
+    editor_buffer_t * closed = editorConfig.current;
+    uint32_t index = editor_buffer_index(closed);
+    memmove(&editorConfig.buffers[index], &editorConfig.buffers[index + 1],
+            sizeof(editor_buffer_t *) * (editorConfig.bufferCount - index - 1));
+    editorConfig.bufferCount--;
+    if (!editorConfig.bufferCount) {
+        editor_add_buffer();
+    }
+    editor_switch_buffer(editorConfig.buffers[index < editorConfig.bufferCount ? index : index - 1]);
+    editor_free_buffer(closed);
+}
+
 /// @brief Deletes the character at the current curser poisition
 static void editor_delete_character() {
-    if (editorConfig.cursorCurrentY == editorConfig.numberOfRows) {
+    if (editorConfig.current->cursorCurrentY == editorConfig.current->numberOfRows) {
+        return;
+    }
+    if (editorConfig.current->cursorCurrentX == 0 && editorConfig.current->cursorCurrentY == 0) {
         return;
     }
-    if (editorConfig.cursorCurrentX == 0 && editorConfig.cursorCurrentY == 0) {
+    if (editorConfig.current->cursorCurrentX > 0) {
+        editor_row_delete_character(editorConfig.current->cursorCurrentY, editorConfig.current->cursorCurrentX - 1);
+        editorConfig.current->cursorCurrentX--;
+    } else {
+        editor_row_t row = *editor_get_row(editorConfig.current->cursorCurrentY);
+        editorConfig.current->cursorCurrentX = editor_get_row(editorConfig.current->cursorCurrentY - 1)->size;
+        editor_row_append_string(editorConfig.current->cursorCurrentY - 1, row.chars, row.size);
+        editor_delete_row(editorConfig.current->cursorCurrentY);
+        editorConfig.current->cursorCurrentY--;
+    }
+}
+
+/// @brief Deletes the line the cursor is currently positioned in or the marked
+/// lines, after they were yanked
+static void editor_delete_lines() {
+    uint32_t begin, end;
+    if (!editor_yank_lines(&begin, &end)) {
         return;
     }
-    editor_row_t * row = &editorConfig.editorRows[editorConfig.cursorCurrentY];
-    if (editorConfig.cursorCurrentX > 0) {
-        editor_row_delete_character(row, editorConfig.cursorCurrentX - 1);
-        editorConfig.cursorCurrentX--;
+    // The gap of the rows stays at the first deleted row, so every row is removed in constant time
+    for (uint32_t at = begin; at < end; at++) {
+        editor_delete_row(begin);
+    }
+    editorConfig.current->cursorCurrentY = begin;
+    if (begin < editorConfig.current->numberOfRows) {
+        uint32_t size = editor_get_row(begin)->size;
+        if (editorConfig.current->cursorCurrentX > size) {
+            editorConfig.current->cursorCurrentX = size;
+        }
     } else {
-        editorConfig.cursorCurrentX = editorConfig.editorRows[editorConfig.cursorCurrentY - 1].size;
-        editor_row_append_string(&editorConfig.editorRows[editorConfig.cursorCurrentY - 1], row->chars, row->size);
-        editor_delete_row(editorConfig.cursorCurrentY);
-        editorConfig.cursorCurrentY--;
+        editorConfig.current->cursorCurrentX = 0;
     }
 }
 
 /// @brief Deletes a complete row in the editor
 /// @param at The index of the row that is deleted
 static void editor_delete_row(uint32_t at) {
-    if (at < 0 || at >= editorConfig.numberOfRows) {
+    if (at < 0 || at >= editorConfig.current->numberOfRows) {
         return;
     }
-    editor_free_row(&editorConfig.editorRows[at]);
-    memmove(&editorConfig.editorRows[at], &editorConfig.editorRows[at + 1],
-            sizeof(editor_row_t) * (editorConfig.numberOfRows - at - 1));
-    for (int j = at; j < editorConfig.numberOfRows - 1; j++) {
-        editorConfig.editorRows[j].index--;
+    editor_delete_rows(at, 1);
+}
+
+/// @brief Deletes several consecutive rows in the editor at once
+/// @param at The index of the first row that is deleted
+/// @param count The amount of rows that are deleted, they have to exist
+static void editor_delete_rows(uint32_t at, uint32_t count) {
+    editor_buffer_t * buffer = editorConfig.current;
+    uint32_t end = at + count;
+    bool outgoingComment = editor_get_row(end - 1)->hightLightOpenComment;
+    for (uint32_t deleted = at; deleted < end; deleted++) {
+        editor_free_row(editor_get_row(deleted));
+    }
+    row_buffer_remove_range(&buffer->editorRows, at, count);
+    buffer->numberOfRows -= count;
+    if (end <= buffer->syntaxValidRows) {
+        buffer->syntaxValidRows -= count;
+        buffer->syntaxConsistentRows -= count;
+        // The following row needs to be highlighted again, if it's multiline comment state is altered
+        bool incomingComment = at > 0 && editor_get_row(at - 1)->hightLightOpenComment;
+        if (outgoingComment != incomingComment) {
+            editor_propagate_syntax(at);
+        }
+    } else if (at < buffer->syntaxValidRows) {
+        // The state of the rows after the deleted ones was not up to date before
+        buffer->syntaxValidRows = buffer->syntaxConsistentRows = at;
+    } else if (at < buffer->syntaxConsistentRows) {
+        buffer->syntaxConsistentRows = at;
     }
-    editorConfig.numberOfRows--;
-    editorConfig.unsavedChanges = true;
+    buffer->unsavedChanges = true;
 }
 
 /// @brief Draws the message bar of the editor
@@ -449,11 +1275,77 @@ static void editor_draw_message_bar(append_buffer_t * buffer) {
     if (msglen > editorConfig.screenColumns) {
         msglen = editorConfig.screenColumns;
     }
-    if (msglen && time(NULL) - editorConfig.statusMessageTimeStamp < editorConfig.config->messageDisplayDuration) {
+    if (msglen &&
+        event_loop_now() - editorConfig.statusMessageTimeStamp < editorConfig.config->messageDisplayDuration * 1000) {
         append_buffer_append_string(buffer, editorConfig.statusMessage, msglen);
     }
 }
 
+/// @brief Frees the render buffer and the syntax highlighting of a row, they
+/// are created again once the row is needed
+/// @param row The row that is released
+static inline void editor_release_row(editor_row_t * row) {
+    if (!row->renderAliased) {
+        free(row->render);
+    }
+    free(row->highLightRuns);
+    free(row->columnMap);
+    row->render = NULL;
+    row->highLightRuns = NULL;
+    row->columnMap = NULL;
+    row->renderSize = row->highLightRunCount = 0;
+    row->highLightCursor = (highlight_runs_cursor_t){0, 0};
+    row->renderAliased = false;
+}
+
+/// @brief Renders the underlying character buffer of a row, tabs are converted
+/// to white space's
+/// @param row The row that is rendered
+/// @details The render buffer of a row without tabs is the underlying character
+/// buffer itself, it is not null terminated if the row is memory mapped. Tab
+/// stops are based on the columns where the characters are displayed
+static void editor_render_row(editor_row_t * row) {
+    free(row->columnMap);
+    row->columnMap = NULL;
+    size_t tabs = 0;
+    size_t j;
+    for (j = 0; j < row->size; j++) {
+        if (row->chars[j] == '\t') {
+            tabs++;
+        }
+    }
+    if (row->renderAliased) {
+        row->render = NULL;
+    }
+    // Without tabs the render buffer would be an exact copy
+    row->renderAliased = tabs == 0;
+    if (row->renderAliased) {
+        free(row->render);
+        row->render = row->chars;
+        row->renderSize = row->size;
+        return;
+    }
+    row->render = realloc(row->render, row->size + tabs * (editorConfig.config->tabStopSize - 1) + 1);
+    size_t idx = 0;
+    uint32_t column = 0;
+    for (j = 0; j < row->size;) {
+        if (row->chars[j] == '\t') {
+            do {
+                row->render[idx++] = ' ';
+            } while (++column % editorConfig.config->tabStopSize != 0);
+            j++;
+        } else {
+            uint32_t length;
+            column += column_map_width(row->chars, row->size, j, &length);
+            memcpy(&row->render[idx], &row->chars[j], length);
+            idx += length;
+            j += length;
+        }
+    }
+    row->render[idx] = '\0';
+    row->renderSize = idx;
+}
+
 /// @brief Appends a single row of the welcome screen to a given append buffer
 /// @param buffer Pointer to the append buffer where the welcome screen row is
 /// appended
@@ -511,74 +1403,151 @@ static void editor_render_welcome_screen_row(append_buffer_t * buffer, uint32_t
     append_buffer_append_string(buffer, welcomeMessageRow, welcomeMessageRowLength);
 }
 
-/// @brief Draws all the rows that are visible in the terminal
-/// @param buffer The buffer where all the rows that are currently visible are
-/// appended
-static void editor_draw_rows(append_buffer_t * buffer) {
-    uint32_t y;
-    for (y = 0; y < editorConfig.screenRows; y++) {
-        uint32_t filerow = y + editorConfig.rowOffset;
-        if (filerow >= editorConfig.numberOfRows) {
-            if (editorConfig.numberOfRows == 0 && y >= editorConfig.screenRows / 3 &&
-                y <= editorConfig.screenRows / 3 + 7) {
-                editor_render_welcome_screen_row(buffer, y - editorConfig.screenRows / 3);
-            } else {
-                append_buffer_append_string(buffer, "~", 1);
-            }
+/// @brief Draws a single row, that is visible in the terminal
+/// @param buffer The buffer where the row is appended
+/// @param y The vertical position of the row on the screen
+static void editor_draw_row(append_buffer_t * buffer, uint32_t y) {
+    uint32_t filerow = y + editorConfig.current->rowOffset;
+    if (filerow >= editorConfig.current->numberOfRows) {
+        if (editorConfig.current->numberOfRows == 0 && y >= editorConfig.screenRows / 3 &&
+            y <= editorConfig.screenRows / 3 + 7) {
+            editor_render_welcome_screen_row(buffer, y - editorConfig.screenRows / 3);
         } else {
-            uint32_t length = editorConfig.editorRows[filerow].renderSize - editorConfig.columnOffset;
-            if (length < 0) {
-                length = 0;
+            append_buffer_append_string(buffer, "~", 1);
+        }
+    } else {
+        editor_row_t * row = editor_prepare_row(filerow);
+        column_map_position_t start = editor_row_find_column(row, editorConfig.current->columnOffset);
+        uint32_t column = start.column;
+        uint32_t renderX = start.render;
+        uint32_t endColumn = editorConfig.current->columnOffset + editorConfig.screenColumns;
+        uint32_t length;
+        // A wide character or a tab, that is cut off by the left edge of the screen, is replaced with white space
+        while (column < editorConfig.current->columnOffset && renderX < row->renderSize) {
+            column += column_map_width(row->render, row->renderSize, renderX, &length);
+            renderX += length;
+        }
+        for (uint32_t x = editorConfig.current->columnOffset; x < column && x < endColumn; x++) {
+            append_buffer_append_string(buffer, " ", 1);
+        }
+        // The run that contains the current character and the render index where it ends
+        uint32_t runIndex = highlight_runs_seek(row->highLightRuns, row->highLightRunCount, &row->highLightCursor,
+                                                renderX);
+        highlight_run_t const * run = &row->highLightRuns[runIndex];
+        uint32_t runEnd = runIndex < row->highLightRunCount
+                              ? row->highLightCursor.start + highlight_run_length(*run)
+                              : UINT32_MAX;
+        unsigned char currentGroup = HIGHTLIGHT_NORMAL;
+        // Matches of the active search are highlighted on top of the syntax highlighting
+        uint32_t matchCount;
+        search_match_t const * match = search_index_find_row(&editorConfig.searchIndex, filerow, &matchCount);
+        uint32_t matchStart = 0, matchEnd = 0;
+        // The row is drawn as spans of characters with the same highlighting, each is appended at once
+        while (renderX < row->renderSize) {
+            while (renderX >= runEnd) {
+                run++;
+                runEnd += highlight_run_length(*run);
             }
-            if (length > editorConfig.screenColumns) {
-                length = editorConfig.screenColumns;
+            while (renderX >= matchEnd && matchCount) {
+                matchStart = editor_row_cx_to_rx(row, match->column);
+                matchEnd = editor_row_cx_to_rx(row, match->column + editorConfig.searchIndex.queryLength);
+                match++;
+                matchCount--;
             }
-            char * c = &editorConfig.editorRows[filerow].render[editorConfig.columnOffset];
-            unsigned char * highLight = &editorConfig.editorRows[filerow].highLight[editorConfig.columnOffset];
-            int32_t current_color = -1;
-            uint32_t j;
-            char str[16];
-            for (j = 0; j < length; j++) {
-                if (iscntrl(c[j])) {
-                    char sym = (c[j] <= 26) ? '@' + c[j] : '?';
-                    append_buffer_append_string(buffer, "\x1b[7m", 4);
-                    append_buffer_append_string(buffer, &sym, 1);
-                    append_buffer_append_string(buffer, "\x1b[m", 3);
-                    if (current_color != -1) {
-                        char buf[16];
-                        int clen = snprintf(buf, sizeof(buf), "\x1b[%dm", current_color);
-                        append_buffer_append_string(buffer, buf, clen);
-                    }
-                } else if (highLight[j] == HIGHTLIGHT_NORMAL) {
-                    if (current_color != -1) {
-                        // Reset back- and foreground color to default
-                        append_buffer_append_string(buffer, "\x1b[39;49m", 8);
-                        current_color = -1;
+            bool insideMatch = renderX >= matchStart && renderX < matchEnd;
+            unsigned char highLightGroup = insideMatch ? HIGHLIGHT_MATCH : highlight_run_group(*run);
+            uint32_t spanEnd = runEnd < row->renderSize ? runEnd : row->renderSize;
+            if (insideMatch && matchEnd < spanEnd) {
+                spanEnd = matchEnd;
+            } else if (!insideMatch && renderX < matchStart && matchStart < spanEnd) {
+                spanEnd = matchStart;
+            }
+            uint32_t spanStart = renderX;
+            bool controlCharacter = false;
+            while (renderX < spanEnd) {
+                unsigned char c = (unsigned char)row->render[renderX];
+                // Printable ASCII characters take up a single column
+                if (c >= ' ' && c < 0x7f) {
+                    if (column == endColumn) {
+                        break;
                     }
-                    append_buffer_append_string(buffer, &c[j], 1);
-                } else {
-                    int32_t color = syntax_convert_to_color(highLight[j]);
-                    if (color != current_color) {
-                        current_color = color;
-                        char buf[36];
-                        // Change the coloring with the 32bit value using the most
-                        // significant byte as a n indicator whether the for- or background
-                        // is colored The three least significant bytes are the rgb values
-                        // for the for- or background coloring
-                        int clen = snprintf(buf, sizeof(buf),
-                                            (color & 0xff000000) ? "\x1b[48;2;%d;%d;%dm" : "\x1b[38;2;%d;%d;%dm",
-                                            (color & 0x00ff0000) >> 16, (color & 0x0000ff00) >> 8, color & 0x000000ff);
-                        append_buffer_append_string(buffer, buf, clen);
+                    column++;
+                    renderX++;
+                    continue;
+                }
+                uint32_t width = column_map_width(row->render, row->renderSize, renderX, &length);
+                if (column + width > endColumn) {
+                    break;
+                }
+                // Control characters are drawn on their own
+                if (length == 1 && iscntrl(c)) {
+                    controlCharacter = true;
+                    break;
+                }
+                column += width;
+                renderX += length;
+            }
+            if (renderX > spanStart) {
+                if (highLightGroup != currentGroup) {
+                    syntax_color_sequence_t const * current = syntax_get_color_sequence(currentGroup);
+                    // A colored background or an attribute is not replaced by the sequence of the next group
+                    if (current->persistent && highLightGroup != HIGHTLIGHT_NORMAL) {
+                        syntax_color_sequence_t const * normal = syntax_get_color_sequence(HIGHTLIGHT_NORMAL);
+                        append_buffer_append_string(buffer, normal->bytes, normal->length);
                     }
-                    append_buffer_append_string(buffer, &c[j], 1);
+                    syntax_color_sequence_t const * sequence = syntax_get_color_sequence(highLightGroup);
+                    append_buffer_append_string(buffer, sequence->bytes, sequence->length);
+                    currentGroup = highLightGroup;
+                }
+                append_buffer_append_string(buffer, &row->render[spanStart], renderX - spanStart);
+            }
+            if (controlCharacter) {
+                char symbol[5] = {'\x1b', '[', '7', 'm', '?'};
+                if (row->render[renderX] <= 26) {
+                    symbol[4] = '@' + row->render[renderX];
                 }
+                append_buffer_append_string(buffer, symbol, 5);
+                append_buffer_append_string(buffer, "\x1b[m", 3);
+                if (currentGroup != HIGHTLIGHT_NORMAL) {
+                    syntax_color_sequence_t const * sequence = syntax_get_color_sequence(currentGroup);
+                    append_buffer_append_string(buffer, sequence->bytes, sequence->length);
+                }
+                column++;
+                renderX++;
+            } else if (renderX < spanEnd) {
+                // The next character does not fit on the screen
+                break;
             }
-            // Reset back- and foreground color to default
-            append_buffer_append_string(buffer, "\x1b[39;49m", 8);
         }
-        append_buffer_append_string(buffer, "\x1b[K", 3);
-        append_buffer_append_string(buffer, "\r\n", 2);
+        // Reset back- and foreground color to default, unless the row ends with default colors already
+        if (currentGroup != HIGHTLIGHT_NORMAL) {
+            syntax_color_sequence_t const * normal = syntax_get_color_sequence(HIGHTLIGHT_NORMAL);
+            append_buffer_append_string(buffer, normal->bytes, normal->length);
+        }
+    }
+    append_buffer_append_string(buffer, "\x1b[K", 3);
+}
+
+/// @brief Scrolls the rows that are still on the screen, when the row offset
+/// changed since the last frame
+/// @param buffer The buffer where the escape sequences are appended
+/// @details Only the rows that are exposed by the scroll have to be sent
+/// afterwards, so scrolling costs bytes proportional to the scroll distance
+static void editor_draw_scroll(append_buffer_t * buffer) {
+    int64_t distance = (int64_t)editorConfig.current->rowOffset - editorConfig.drawnRowOffset;
+    uint32_t shift = distance < 0 ? (uint32_t)-distance : (uint32_t)distance;
+    // Rows that are scrolled horizontally differ anyway
+    if (!editorConfig.frameCache.valid || !distance || shift >= editorConfig.screenRows ||
+        editorConfig.current->columnOffset != editorConfig.drawnColumnOffset) {
+        return;
     }
+    char buf[32];
+    // The scroll region excludes the status and the message bar, resetting the
+    // region moves the cursor to the upper left corner
+    int length = snprintf(buf, sizeof(buf), "\x1b[?25l\x1b[1;%ur\x1b[%u%c\x1b[r", editorConfig.screenRows, shift,
+                          distance > 0 ? 'S' : 'T');
+    append_buffer_append_string(buffer, buf, length);
+    frame_cache_scroll(&editorConfig.frameCache, 0, editorConfig.screenRows, (int32_t)distance);
 }
 
 /// @brief Draws the status bar of the editor
@@ -587,15 +1556,33 @@ static void editor_draw_rows(append_buffer_t * buffer) {
 static void editor_draw_status_bar(append_buffer_t * buffer) {
     append_buffer_append_string(buffer, "\x1b[7m", 4);
     char statusBarLeftMessage[4200], StatusBarRightMessage[80], realPath[4096];
-    if (editorConfig.fileName) {
-        realpath(editorConfig.fileName, realPath);
+    if (editorConfig.current->fileName) {
+        realpath(editorConfig.current->fileName, realPath);
+    }
+    int leftMessageLength;
+    if (editorConfig.hudVisible) {
+        // The measurements of the current frame are not complete yet
+        editor_frame_statistics_t const * statistics = &editorConfig.lastFrameStatistics;
+        leftMessageLength = snprintf(statusBarLeftMessage, sizeof(statusBarLeftMessage),
+                                     "render %.2f ms | highlight %.2f ms, %u rows | %zu bytes | %zu KiB",
+                                     statistics->renderTime / 1e6, statistics->highlightTime / 1e6,
+                                     statistics->rowsHighlighted, statistics->bytesWritten,
+                                     statistics->residentMemory / 1024);
+    } else {
+        leftMessageLength = snprintf(statusBarLeftMessage, sizeof(statusBarLeftMessage), "%.80s - %d lines %s",
+                                     editorConfig.current->fileName ? realPath : "[No file name]",
+                                     editorConfig.current->numberOfRows,
+                                     editorConfig.current->unsavedChanges ? "(modified)" : "");
+        // The position of the file is shown, as soon as multiple files are opened
+        if (editorConfig.bufferCount > 1 && leftMessageLength < (int)sizeof(statusBarLeftMessage)) {
+            leftMessageLength += snprintf(&statusBarLeftMessage[leftMessageLength],
+                                          sizeof(statusBarLeftMessage) - leftMessageLength, " [%u/%u]",
+                                          editor_buffer_index(editorConfig.current) + 1, editorConfig.bufferCount);
+        }
     }
-    int leftMessageLength = snprintf(statusBarLeftMessage, sizeof(statusBarLeftMessage), "%.80s - %d lines %s",
-                                     editorConfig.fileName ? realPath : "[No file name]", editorConfig.numberOfRows,
-                                     editorConfig.unsavedChanges ? "(modified)" : "");
     int rightMessageLength = snprintf(StatusBarRightMessage, sizeof(StatusBarRightMessage), "%s | %d/%d",
-                                      editorConfig.syntax ? editorConfig.syntax->filetype : "",
-                                      editorConfig.cursorCurrentY + 1, editorConfig.numberOfRows);
+                                      editorConfig.current->syntax ? editorConfig.current->syntax->filetype : "",
+                                      editorConfig.current->cursorCurrentY + 1, editorConfig.current->numberOfRows);
     if (leftMessageLength > editorConfig.screenColumns) {
         leftMessageLength = editorConfig.screenColumns;
     }
@@ -610,82 +1597,234 @@ static void editor_draw_status_bar(append_buffer_t * buffer) {
         }
     }
     append_buffer_append_string(buffer, "\x1b[m", 3);
-    append_buffer_append_string(buffer, "\r\n", 2);
+}
+
+/// @brief Releases the render buffers, the syntax highlighting and the column
+/// maps of the rows of all opened files, that were used least recently, once
+/// they exceed the memory budget
+/// @details The rows are released until three quarters of the budget are used,
+/// rows that were used for the last frame are kept. The released rows are
+/// created again once they are needed, their multiline comment state is kept
+static void editor_enforce_memory_budget() {
+    size_t budget = editorConfig.config->memoryBudget * 1024 * 1024;
+    if (!budget || editorConfig.derivedMemory <= budget) {
+        return;
+    }
+    // The estimate only grows, so the exact amount is determined first
+    size_t total = 0;
+    uint32_t usageCount = 0;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        for (uint32_t at = 0; at < buffer->numberOfRows; at++) {
+            size_t size = editor_row_derived_size(row_buffer_at(&buffer->editorRows, at));
+            total += size;
+            usageCount += size ? 1 : 0;
+        }
+    }
+    size_t target = budget / 4 * 3;
+    editor_row_usage_t * usages = total > target ? malloc(sizeof(editor_row_usage_t) * usageCount) : NULL;
+    if (usages == NULL) {
+        editorConfig.derivedMemory = total;
+        return;
+    }
+    uint32_t usageIndex = 0;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        for (uint32_t at = 0; at < buffer->numberOfRows; at++) {
+            editor_row_t * row = row_buffer_at(&buffer->editorRows, at);
+            size_t size = editor_row_derived_size(row);
+            if (size) {
+                usages[usageIndex++] = (editor_row_usage_t){row->lastUse, size};
+            }
+        }
+    }
+    qsort(usages, usageCount, sizeof(editor_row_usage_t), editor_compare_row_usage);
+    // Every row that was used in the same frame as the last released row is released as well
+    size_t released = 0;
+    uint32_t releasedUse = 0;
+    bool releasing = false;
+    for (uint32_t i = 0; i < usageCount && total - released > target; i++) {
+        if (usages[i].lastUse == editorConfig.frameNumber) {
+            break;
+        }
+        released += usages[i].size;
+        releasedUse = usages[i].lastUse;
+        releasing = true;
+    }
+    free(usages);
+    if (!releasing) {
+        editorConfig.derivedMemory = total;
+        return;
+    }
+    released = 0;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        for (uint32_t at = 0; at < buffer->numberOfRows; at++) {
+            editor_row_t * row = row_buffer_at(&buffer->editorRows, at);
+            size_t size = editor_row_derived_size(row);
+            if (size && row->lastUse <= releasedUse) {
+                editor_release_row(row);
+                released += size;
+            }
+        }
+    }
+    editorConfig.derivedMemory = total - released;
 }
 
 /// @brief Executes the currently opened file
 /// @details Currently only executing cellox, jbasic lua and python files is
-/// supported
+/// supported. The program runs in the background and its output is added to an
+/// output buffer, that is displayed instead of the file. Only the last rows of
+/// the output are kept
 static void editor_execute() {
-    char const * commandPreFix;
-    if (!editorConfig.syntax) {
+    char const * program;
+    if (!editorConfig.current->syntax) {
         editor_set_status_message("Unknown filetype");
         return;
     }
-    if (!strcmp(editorConfig.syntax->filetype, "Cellox")) {
-        commandPreFix = "Cellox ";
-    } else if (!strcmp(editorConfig.syntax->filetype, "JBASIC")) {
-        commandPreFix = "JBASIC ";
-    } else if (!strcmp(editorConfig.syntax->filetype, "Lua")) {
-        commandPreFix = "lua ";
-    } else if (!strcmp(editorConfig.syntax->filetype, "Python")) {
-        commandPreFix = "python3 ";
+    if (!strcmp(editorConfig.current->syntax->filetype, "Cellox")) {
+        program = "Cellox";
+    } else if (!strcmp(editorConfig.current->syntax->filetype, "JBASIC")) {
+        program = "JBASIC";
+    } else if (!strcmp(editorConfig.current->syntax->filetype, "Lua")) {
+        program = "lua";
+    } else if (!strcmp(editorConfig.current->syntax->filetype, "Python")) {
+        program = "python3";
     } else {
-        editor_set_status_message("Executing %s files is not supported", editorConfig.syntax->filetype);
+        editor_set_status_message("Executing %s files is not supported", editorConfig.current->syntax->filetype);
         return;
     }
-    // Clears the screen when the editor is quit
-    write(STDOUT_FILENO, "\x1b[2J", 4);
-    write(STDOUT_FILENO, "\x1b[H", 3);
-    editor_disable_raw_mode();
-    char command[4096];
-    command[0] = '\0';
-    strcat(command, commandPreFix);
-    strcat(command, editorConfig.fileName);
-    system(command);
-    char line[1024];
-    printf("Press enter to continue...\n");
-    fgets(line, sizeof(line), stdin);
-
-    editor_enable_raw_mode();
-    editor_refresh_screen();
+    char const * fileName = editorConfig.current->fileName;
+    char outputName[PATH_MAX];
+    snprintf(outputName, sizeof(outputName), "%s.output", fileName);
+    editor_buffer_t * output = NULL;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        if (editorConfig.buffers[i]->executeProgram && !strcmp(editorConfig.buffers[i]->fileName, outputName)) {
+            output = editorConfig.buffers[i];
+        }
+    }
+    if (output && (output->executeProcess || output->executeFileDescriptor != -1)) {
+        editor_switch_buffer(output);
+        editor_set_status_message("%s is still running, close its output to stop it", fileName);
+        return;
+    }
+    // The file on the disk is executed, so a save in progress needs to be completed
+    editor_finish_save(true);
+    int pipeDescriptors[2];
+    if (pipe(pipeDescriptors) == -1) {
+        editor_set_status_message("Could not execute %s: %s", fileName, strerror(errno));
+        return;
+    }
+    // Neither end is inherited by other executed programs, the write end is duplicated onto the output of the child
+    if (fcntl(pipeDescriptors[0], F_SETFD, FD_CLOEXEC) == -1 || fcntl(pipeDescriptors[1], F_SETFD, FD_CLOEXEC) == -1) {
+        editor_set_status_message("Could not execute %s: %s", fileName, strerror(errno));
+        close(pipeDescriptors[0]);
+        close(pipeDescriptors[1]);
+        return;
+    }
+    pid_t process = fork();
+    if (process == -1) {
+        close(pipeDescriptors[0]);
+        close(pipeDescriptors[1]);
+        editor_set_status_message("Could not execute %s: %s", fileName, strerror(errno));
+        return;
+    }
+    if (process == 0) {
+        // The program must not read the keys that are meant for the editor
+        int input = open("/dev/null", O_RDONLY);
+        if (input != -1) {
+            dup2(input, STDIN_FILENO);
+        }
+        dup2(pipeDescriptors[1], STDOUT_FILENO);
+        dup2(pipeDescriptors[1], STDERR_FILENO);
+        // Python buffers its output, when it is not written to a terminal
+        setenv("PYTHONUNBUFFERED", "1", 1);
+        execlp(program, program, fileName, (char *)NULL);
+        fprintf(stderr, "Could not execute %s: %s\n", program, strerror(errno));
+        _exit(127);
+    }
+    close(pipeDescriptors[1]);
+    // The output is only read while it is available, so the editor never waits for the program
+    int flags = fcntl(pipeDescriptors[0], F_GETFL);
+    if (flags == -1 || fcntl(pipeDescriptors[0], F_SETFL, flags | O_NONBLOCK) == -1 ||
+        !event_loop_watch(&editorConfig.eventLoop, pipeDescriptors[0], editor_read_program_output)) {
+        close(pipeDescriptors[0]);
+        kill(process, SIGKILL);
+        waitpid(process, NULL, 0);
+        editor_set_status_message("Could not read the output of %s", fileName);
+        return;
+    }
+    if (!output) {
+        output = editor_add_buffer();
+        output->fileName = strdup(outputName);
+    } else {
+        // The output of the previous execution is replaced
+        editor_buffer_t * current = editorConfig.current;
+        editorConfig.current = output;
+        editor_free_rows();
+        editorConfig.current = current;
+        output->cursorCurrentX = output->cursorCurrentY = output->rowOffset = output->columnOffset = 0;
+    }
+    output->followMaximumRows = EXECUTE_MAXIMUM_ROWS;
+    output->followPartialRow = false;
+    output->executeProgram = program;
+    output->executeProcess = process;
+    output->executeFileDescriptor = pipeDescriptors[0];
+    editor_switch_buffer(output);
+    editor_set_status_message("Executing %s, ctrl-n switches back to the file", fileName);
+}
+
+/// @brief Redraws the screen once the status message expired, so it is hidden
+static void editor_expire_status_message() {
+    editorConfig.redrawPending = true;
 }
 
 /// @brief Finds all occurences of a word in the currently oppend source file
 static void editor_find() {
-    uint32_t savedCurrentX = editorConfig.cursorCurrentX;
-    uint32_t savedCurrentY = editorConfig.cursorCurrentY;
-    uint32_t savedColumnOffset = editorConfig.columnOffset;
-    uint32_t savedRowOffset = editorConfig.rowOffset;
-    char * query = editor_prompt("Search: %s (Use ESC/Arrows/Enter)", editor_find_callback);
+    uint32_t savedCurrentX = editorConfig.current->cursorCurrentX;
+    uint32_t savedCurrentY = editorConfig.current->cursorCurrentY;
+    uint32_t savedColumnOffset = editorConfig.current->columnOffset;
+    uint32_t savedRowOffset = editorConfig.current->rowOffset;
+    char * query = editor_prompt("Search: %s (Use ESC/Arrows/Enter)", editor_find_callback, false);
     if (query) {
         free(query);
     } else {
-        editorConfig.cursorCurrentX = savedCurrentX;
-        editorConfig.cursorCurrentY = savedCurrentY;
-        editorConfig.columnOffset = savedColumnOffset;
-        editorConfig.rowOffset = savedRowOffset;
+        editorConfig.current->cursorCurrentX = savedCurrentX;
+        editorConfig.current->cursorCurrentY = savedCurrentY;
+        editorConfig.current->columnOffset = savedColumnOffset;
+        editorConfig.current->rowOffset = savedRowOffset;
     }
 }
 
-/// @brief Callback of the find function
+/// @brief Searches the opened files for a file
+/// @param filePath The path of the file
+/// @return The buffer that contains the file or NULL if the file was not opened
+static editor_buffer_t * editor_find_buffer(char const * filePath) {
+    char path[PATH_MAX], openedPath[PATH_MAX];
+    if (!realpath(filePath, path)) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        char const * fileName = editorConfig.buffers[i]->fileName;
+        if (fileName && realpath(fileName, openedPath) && !strcmp(path, openedPath)) {
+            return editorConfig.buffers[i];
+        }
+    }
+    return NULL;
+}
+
+/// @brief Callback of the find function
 /// @param query The word that is searched for
 /// @param key The key that was pressed previously
 static void editor_find_callback(char * query, uint32_t key) {
     static int32_t lastMatch = -1;
     static int32_t direction = 1;
-    static int32_t savedHighLightedLine;
-    static char * savedHighLight = NULL;
-    if (savedHighLight) {
-        memcpy(editorConfig.editorRows[savedHighLightedLine].highLight, savedHighLight,
-               editorConfig.editorRows[savedHighLightedLine].renderSize);
-        free(savedHighLight);
-        savedHighLight = NULL;
-    }
+    search_index_t * index = &editorConfig.searchIndex;
 
     if (key == '\r' || key == '\x1b') {
         lastMatch = -1;
         direction = 1;
+        search_index_free(index);
         return;
     } else if (key == ARROW_RIGHT || key == ARROW_DOWN) {
         direction = 1;
@@ -694,41 +1833,254 @@ static void editor_find_callback(char * query, uint32_t key) {
     } else {
         lastMatch = -1;
         direction = 1;
+        // The underlying characters are searched, so rows that were not rendered yet don't need to be rendered
+        if (!search_index_update(index, &editorConfig.current->editorRows, query, strlen(query))) {
+            editor_set_status_message("Not enough memory to search for %s", query);
+            return;
+        }
+    }
+    if (index->count == 0) {
+        return;
     }
     if (lastMatch == -1) {
-        direction = 1;
+        lastMatch = 0;
+    } else {
+        lastMatch = (lastMatch + direction + (int32_t)index->count) % (int32_t)index->count;
     }
-    int32_t current = lastMatch;
-    size_t i;
-    for (i = 0; i < editorConfig.numberOfRows; i++) {
-        current += direction;
-        if (current == -1) {
-            current = editorConfig.numberOfRows - 1;
-        } else if (current == editorConfig.numberOfRows) {
-            current = 0;
-        }
-        editor_row_t * row = &editorConfig.editorRows[current];
-        char * match = strstr(row->render, query);
-        if (match) {
-            lastMatch = current;
-            editorConfig.cursorCurrentY = current;
-            editorConfig.cursorCurrentX = editor_row_rx_to_cx(row, match - row->render) + 1;
-            editorConfig.rowOffset = editorConfig.numberOfRows;
-            savedHighLightedLine = current;
-            savedHighLight = malloc(row->renderSize);
-            memcpy(savedHighLight, row->highLight, row->renderSize);
-            memset(&row->highLight[match - row->render], HIGHLIGHT_MATCH, strlen(query));
-            break;
+    search_match_t const * match = &index->matches[lastMatch];
+    editorConfig.current->cursorCurrentY = match->row;
+    editorConfig.current->cursorCurrentX = match->column + 1;
+    editorConfig.current->rowOffset = editorConfig.current->numberOfRows;
+}
+
+/// @brief Finds the ranges of rows that were not modified since the file was
+/// opened and that follow each other in the memory mapped file
+/// @param count Is set to the amount of ranges that were found
+/// @return The ranges that are at least SAVE_COPY_MINIMUM_SIZE bytes long,
+/// ordered by their first row - NULL if there are none
+/// @details A row is unmodified, if it's characters are followed by a newline
+/// in the memory mapped file. So the bytes of a range are exactly the rows of
+/// the range followed by a newline each
+static save_job_copy_t * editor_find_unmodified_ranges(uint32_t * count) {
+    editor_buffer_t * buffer = editorConfig.current;
+    save_job_copy_t * copies = NULL;
+    uint32_t capacity = 0;
+    *count = 0;
+    if (buffer->mapping == NULL) {
+        return NULL;
+    }
+    save_job_copy_t range = {0, 0, 0, 0};
+    for (uint32_t at = 0; at <= buffer->numberOfRows; at++) {
+        editor_row_t const * row = at < buffer->numberOfRows ? editor_get_row(at) : NULL;
+        bool unmodified = row && row->mapped && row->chars >= buffer->mapping &&
+                          row->chars < buffer->mapping + buffer->mappingLength &&
+                          (size_t)(row->chars - buffer->mapping) + row->size < buffer->mappingLength &&
+                          row->chars[row->size] == '\n';
+        off_t offset = unmodified ? row->chars - buffer->mapping : 0;
+        if (unmodified && range.lineCount && offset == range.offset + (off_t)range.length) {
+            range.lineCount++;
+            range.length += row->size + 1;
+            continue;
         }
+        if (range.length >= SAVE_COPY_MINIMUM_SIZE) {
+            if (*count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                save_job_copy_t * grown = realloc(copies, sizeof(save_job_copy_t) * capacity);
+                // The rows are written like all other rows instead
+                if (grown == NULL) {
+                    free(copies);
+                    *count = 0;
+                    return NULL;
+                }
+                copies = grown;
+            }
+            copies[(*count)++] = range;
+        }
+        range = unmodified ? (save_job_copy_t){at, 1, offset, (size_t)row->size + 1} : (save_job_copy_t){0, 0, 0, 0};
+    }
+    return copies;
+}
+
+/// @brief Adds the exit status of the executed program of a buffer to its
+/// rows, once the program exited and its output ended
+/// @param buffer The buffer that contains the output of the program
+static void editor_finish_program(editor_buffer_t * buffer) {
+    if (buffer->executeProcess || buffer->executeFileDescriptor != -1) {
+        return;
+    }
+    char result[64];
+    if (WIFSIGNALED(buffer->executeStatus)) {
+        snprintf(result, sizeof(result), "terminated by signal %d", WTERMSIG(buffer->executeStatus));
+    } else {
+        snprintf(result, sizeof(result), "exited with status %d", WEXITSTATUS(buffer->executeStatus));
     }
+    char line[128];
+    int length = snprintf(line, sizeof(line), "[%s %s]\n", buffer->executeProgram, result);
+    editor_buffer_t * displayed = editorConfig.current;
+    editorConfig.current = buffer;
+    bool followCursor = buffer->cursorCurrentY + 1 >= buffer->numberOfRows;
+    bool unsavedChanges = buffer->unsavedChanges;
+    // The output might not end with a line break
+    buffer->followPartialRow = false;
+    editor_follow_rows(editor_append_followed_text(line, (size_t)length), followCursor, buffer == displayed);
+    buffer->unsavedChanges = unsavedChanges;
+    editorConfig.current = displayed;
+    editor_set_status_message("%s %s", buffer->executeProgram, result);
+}
+
+/// @brief Completes a save in progress, once the rows were written
+/// @param wait Determines whether to wait for the save, if it is not done yet
+/// @return true if a save was completed, false if not
+static bool editor_finish_save(bool wait) {
+    save_job_t * job = &editorConfig.current->saveJob;
+    if (!job->running) {
+        return false;
+    }
+    if (wait) {
+        save_job_wait(job);
+    } else if (!save_job_poll(job)) {
+        return false;
+    }
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_get_row(at)->shared = false;
+    }
+    if (job->error) {
+        editorConfig.current->unsavedChanges = true;
+        editor_set_status_message("Can't save! I/O error: %s", strerror(job->error));
+    } else {
+        editor_set_status_message("%zu bytes written to disk", job->bytesWritten);
+    }
+    // Frees the buffers of the rows that were modified while saving
+    save_job_reset(job);
+    return true;
+}
+
+/// @brief Moves the cursor and the viewport of the opened buffer along with the
+/// rows that were added to it
+/// @param droppedRows The amount of the oldest rows that were dropped
+/// @param followCursor Determines whether the cursor was on the last row, so it
+/// is moved to the new last row
+/// @param displayed Determines whether the buffer is displayed, so the rows on
+/// the screen are scrolled along with the dropped rows
+static void editor_follow_rows(uint32_t droppedRows, bool followCursor, bool displayed) {
+    editor_buffer_t * buffer = editorConfig.current;
+    if (droppedRows) {
+        buffer->cursorCurrentY = buffer->cursorCurrentY > droppedRows ? buffer->cursorCurrentY - droppedRows : 0;
+        buffer->rowOffset = buffer->rowOffset > droppedRows ? buffer->rowOffset - droppedRows : 0;
+        if (displayed) {
+            // The rows that are still on the screen moved up, so they are scrolled instead of drawn again
+            editorConfig.drawnRowOffset =
+                editorConfig.drawnRowOffset > droppedRows ? editorConfig.drawnRowOffset - droppedRows : 0;
+        }
+    }
+    if (followCursor && buffer->numberOfRows && buffer->cursorCurrentY != buffer->numberOfRows - 1) {
+        buffer->cursorCurrentY = buffer->numberOfRows - 1;
+        buffer->cursorCurrentX = 0;
+    }
+    if (buffer->cursorCurrentY < buffer->numberOfRows &&
+        buffer->cursorCurrentX > editor_get_row(buffer->cursorCurrentY)->size) {
+        buffer->cursorCurrentX = editor_get_row(buffer->cursorCurrentY)->size;
+    }
+}
+
+/// @brief Determines the offset of the first line of a file, that is kept when
+/// the file is followed
+/// @param fileDescriptor The file descriptor of the followed file
+/// @param fileSize The size of the file
+/// @param maximumRows The maximum amount of rows that are kept, 0 if all rows
+/// are kept
+/// @return The offset of the first line of the last lines of the file
+/// @details The file is searched backwards from its end, so the lines before
+/// are never read
+static off_t editor_follow_start(int fileDescriptor, off_t fileSize, uint32_t maximumRows) {
+    if (!maximumRows) {
+        return 0;
+    }
+    char chunk[FOLLOW_READ_SIZE];
+    uint32_t lineBreaks = 0;
+    off_t end = fileSize;
+    while (end > 0) {
+        off_t begin = end > FOLLOW_READ_SIZE ? end - FOLLOW_READ_SIZE : 0;
+        if (pread(fileDescriptor, chunk, end - begin, begin) != end - begin) {
+            return 0;
+        }
+        for (off_t i = end - begin; i > 0; i--) {
+            if (chunk[i - 1] != '\n') {
+                continue;
+            }
+            // The line break at the end of the file terminates the last line, instead of starting another one
+            off_t lineStart = begin + i;
+            if (lineStart != fileSize && ++lineBreaks == maximumRows) {
+                return lineStart;
+            }
+        }
+        end = begin;
+    }
+    return 0;
+}
+
+/// @brief Frees a buffer that is not displayed anymore
+/// @param buffer The buffer that is freed, including its rows
+static void editor_free_buffer(editor_buffer_t * buffer) {
+    editor_buffer_t * current = editorConfig.current;
+    // The rows are freed through the displayed buffer
+    editorConfig.current = buffer;
+    editor_free_rows();
+    editorConfig.current = current;
+    if (buffer->followFileDescriptor != -1) {
+        close(buffer->followFileDescriptor);
+    }
+    if (buffer->executeFileDescriptor != -1) {
+        event_loop_unwatch(&editorConfig.eventLoop, buffer->executeFileDescriptor);
+        close(buffer->executeFileDescriptor);
+    }
+    if (buffer->executeProcess) {
+        // Nobody would read the output of the program anymore
+        kill(buffer->executeProcess, SIGKILL);
+        waitpid(buffer->executeProcess, NULL, 0);
+    }
+    save_job_free(&buffer->saveJob);
+    free(buffer->fileName);
+    free(buffer);
 }
 
 /// @brief Frees the contents of a single row
 /// @param row  The row where the contents are freed
 static inline void editor_free_row(editor_row_t * row) {
-    free(row->render);
-    free(row->chars);
-    free(row->highLight);
+    if (!row->renderAliased) {
+        free(row->render);
+    }
+    if (row->shared) {
+        if (!save_job_defer_free(&editorConfig.current->saveJob, row->chars)) {
+            editor_die("save_job_defer_free");
+        }
+    } else if (!row->mapped) {
+        free(row->chars);
+    }
+    free(row->highLightRuns);
+    free(row->columnMap);
+}
+
+/// @brief Frees all the rows of the opened buffer and the memory mapped file or
+/// the row arena they might point into
+static void editor_free_rows() {
+    // The rows and the memory mapped file might still be written by a save in progress
+    editor_finish_save(true);
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_free_row(editor_get_row(at));
+    }
+    row_buffer_free(&editorConfig.current->editorRows);
+    editorConfig.current->numberOfRows = editorConfig.current->syntaxValidRows =
+        editorConfig.current->syntaxConsistentRows = 0;
+    editor_unmap_file();
+    row_arena_free(&editorConfig.current->rowArena);
+}
+
+/// @brief Gets the row at the specified index of the opened buffer
+/// @param at The index of the row
+/// @return Pointer to the row, that is valid until rows are inserted or deleted
+static inline editor_row_t * editor_get_row(uint32_t at) {
+    return row_buffer_at(&editorConfig.current->editorRows, at);
 }
 
 /// @brief Determines the position of the curser
@@ -784,32 +2136,197 @@ static int32_t editor_get_window_size(uint32_t * rows, uint32_t * columns) {
     }
 }
 
+/// @brief Determines whether the selected syntax highlighting configuration
+/// supports multiline comments
+/// @return true if multiline comments are supported, false if not
+static inline bool editor_has_multiline_comments() {
+    return editorConfig.current->syntax && editorConfig.current->syntax->multiline_comment_start &&
+           *editorConfig.current->syntax->multiline_comment_start;
+}
+
+/// @brief Applies the syntax highlighting to a part of the render buffer of a
+/// single row
+/// @param row The row that is highlighted
+/// @param from The index in the render buffer where the highlighting starts,
+/// the lexer must not be inside of a string or a token at that position
+/// @param insideComment Determines whether the row is inside a multiline
+/// comment at that position
+/// @param resumeAfter Once the lexer passes this index and reaches a separator
+/// that was highlighted as normal text before, the rest of the row is already
+/// highlighted correctly and the highlighting stops
+/// @return true if the row ends inside a multiline comment, false if not
+static bool editor_highlight_range(editor_row_t * row, unsigned char * highLight, uint32_t from, bool insideComment,
+                                   uint32_t resumeAfter) {
+    return lexer_highlight(&editorConfig.current->lexer, row->render, row->renderSize, highLight, from, insideComment,
+                           resumeAfter, row->hightLightOpenComment, NULL);
+}
+
+/// @brief Applies the syntax highlighting to the render buffer of a single row,
+/// without storing it in the row
+/// @param row The row that is highlighted
+/// @param highLight Destination for the highlight group of every character
+/// @param insideComment Determines whether the row starts inside a multiline
+/// comment
+/// @return true if the row ends inside a multiline comment, false if not
+static bool editor_highlight_columns(editor_row_t * row, unsigned char * highLight, bool insideComment) {
+    memset(highLight, HIGHTLIGHT_NORMAL, row->renderSize);
+
+    if (editorConfig.current->syntax == NULL) {
+        return false;
+    }
+    return editor_highlight_range(row, highLight, 0, insideComment, UINT32_MAX);
+}
+
+/// @brief Applies the syntax highlighting to the render buffer of a single row
+/// @param row The row that is highlighted
+/// @param insideComment Determines whether the row starts inside a multiline
+/// comment
+/// @return true if the row ends inside a multiline comment, false if not
+static bool editor_highlight_row(editor_row_t * row, bool insideComment) {
+    uint64_t start = editor_is_profiling() ? editor_now() : 0;
+    unsigned char * highLight = editor_reserve_highlight_columns(row->renderSize);
+    insideComment = editor_highlight_columns(row, highLight, insideComment);
+    if (!highlight_runs_encode(&row->highLightRuns, &row->highLightRunCount, highLight, row->renderSize)) {
+        editor_die("highlight_runs_encode");
+    }
+    row->highLightCursor = (highlight_runs_cursor_t){0, 0};
+    if (start) {
+        editor_record_highlight(start);
+    }
+    return insideComment;
+}
+
+/// @brief Initializes a row, that is not rendered yet
+/// @param row The uninitialized row
+/// @param chars The underlying character buffer of the row
+/// @param length The length of the row
+/// @param mapped Determines whether the character buffer is owned by the row
+static inline void editor_init_row(editor_row_t * row, char * chars, size_t length, bool mapped) {
+    row->size = length;
+    row->renderSize = 0;
+    row->chars = chars;
+    row->render = NULL;
+    row->highLightRuns = NULL;
+    row->highLightRunCount = 0;
+    row->highLightCursor = (highlight_runs_cursor_t){0, 0};
+    row->columnMap = NULL;
+    row->lastUse = 0;
+    row->hightLightOpenComment = false;
+    row->mapped = mapped;
+    row->renderAliased = row->shared = false;
+}
+
 /// @brief Inserts a character at the current position
 /// @param c The character that is inserted
 static void editor_insert_character(uint32_t c) {
-    if (editorConfig.cursorCurrentY == editorConfig.numberOfRows) {
-        editor_insert_row(editorConfig.numberOfRows, "", 0);
+    if (editorConfig.current->cursorCurrentY == editorConfig.current->numberOfRows) {
+        editor_insert_row(editorConfig.current->numberOfRows, "", 0);
     }
-    editor_row_insert_character(&editorConfig.editorRows[editorConfig.cursorCurrentY], editorConfig.cursorCurrentX, c);
-    editorConfig.cursorCurrentX++;
+    editor_row_insert_character(editorConfig.current->cursorCurrentY, editorConfig.current->cursorCurrentX, c);
+    editorConfig.current->cursorCurrentX++;
 }
 
 /// @brief Inserts a new line a the current cursor position
 static void editor_insert_newline() {
-    if (editorConfig.cursorCurrentX == 0) {
-        editor_insert_row(editorConfig.cursorCurrentY, "", 0);
+    if (editorConfig.current->cursorCurrentX == 0) {
+        editor_insert_row(editorConfig.current->cursorCurrentY, "", 0);
     } else {
         // We need to split the current row at our current x position
-        editor_row_t * row = &editorConfig.editorRows[editorConfig.cursorCurrentY];
-        editor_insert_row(editorConfig.cursorCurrentY + 1, &row->chars[editorConfig.cursorCurrentX],
-                          row->size - editorConfig.cursorCurrentX);
-        row = &editorConfig.editorRows[editorConfig.cursorCurrentY];
-        row->size = editorConfig.cursorCurrentX;
+        editor_row_t * row = editor_get_row(editorConfig.current->cursorCurrentY);
+        editor_insert_row(editorConfig.current->cursorCurrentY + 1, &row->chars[editorConfig.current->cursorCurrentX],
+                          row->size - editorConfig.current->cursorCurrentX);
+        row = editor_get_row(editorConfig.current->cursorCurrentY);
+        editor_row_detach(row);
+        row->size = editorConfig.current->cursorCurrentX;
         row->chars[row->size] = '\0';
-        editor_update_row(row);
+        editor_update_row(editorConfig.current->cursorCurrentY);
     }
-    editorConfig.cursorCurrentY++;
-    editorConfig.cursorCurrentX = 0;
+    editorConfig.current->cursorCurrentY++;
+    editorConfig.current->cursorCurrentX = 0;
+}
+
+/// @brief Inserts text at the current cursor position, line breaks split the
+/// text into rows
+/// @param text The text that is inserted
+/// @param length The length of the text
+/// @details The rows are created in a single pass without rendering them.
+/// Afterwards only the new rows are scanned for their multiline comment state,
+/// the rows after them stay consistent with each other
+static void editor_insert_text(char const * text, size_t length) {
+    if (editorConfig.current->cursorCurrentY == editorConfig.current->numberOfRows) {
+        editor_insert_row(editorConfig.current->numberOfRows, "", 0);
+    }
+    uint32_t at = editorConfig.current->cursorCurrentY;
+    uint32_t validRows = editorConfig.current->syntaxValidRows;
+    editor_row_t * row = editor_get_row(at);
+    editor_row_detach(row);
+    editor_release_row(row);
+    // The part of the row after the cursor is moved behind the last line of the text
+    size_t tailLength = row->size - editorConfig.current->cursorCurrentX;
+    char * tail = malloc(tailLength + 1);
+    if (tail == NULL) {
+        editor_die("malloc");
+    }
+    memcpy(tail, &row->chars[editorConfig.current->cursorCurrentX], tailLength);
+    row->size = editorConfig.current->cursorCurrentX;
+    uint32_t insertedRows = 0;
+    size_t lineStart = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && text[i] != '\r' && text[i] != '\n') {
+            continue;
+        }
+        if (insertedRows == 0) {
+            editor_row_append_unrendered(row, &text[lineStart], i - lineStart);
+        } else {
+            char * chars = malloc(i - lineStart + 1);
+            if (chars == NULL) {
+                editor_die("malloc");
+            }
+            memcpy(chars, &text[lineStart], i - lineStart);
+            chars[i - lineStart] = '\0';
+            editor_insert_unrendered_row(at + insertedRows, chars, i - lineStart, false);
+        }
+        if (i == length) {
+            break;
+        }
+        // Terminals might send a carriage return followed by a line feed
+        if (text[i] == '\r' && i + 1 < length && text[i + 1] == '\n') {
+            i++;
+        }
+        lineStart = i + 1;
+        insertedRows++;
+    }
+    row = editor_get_row(at + insertedRows);
+    editorConfig.current->cursorCurrentY = at + insertedRows;
+    editorConfig.current->cursorCurrentX = row->size;
+    editor_row_append_unrendered(row, tail, tailLength);
+    free(tail);
+
+    if (at < validRows) {
+        // The rows after the text were highlighted based on the row the text was inserted into
+        editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows = at;
+        editor_scan_syntax(at + insertedRows + 1);
+        editorConfig.current->syntaxConsistentRows = validRows + insertedRows;
+    } else if (at < editorConfig.current->syntaxConsistentRows) {
+        editorConfig.current->syntaxConsistentRows = at;
+    }
+    editorConfig.current->unsavedChanges = true;
+}
+
+/// @brief Inserts a row without rendering it
+/// @param at The index of the new row
+/// @param chars The underlying character buffer of the row
+/// @param length The length of the row
+/// @param mapped Determines whether the character buffer is owned by the row
+/// @details The render buffer and the syntax highlighting are created once the
+/// row is needed
+static void editor_insert_unrendered_row(uint32_t at, char * chars, size_t length, bool mapped) {
+    editor_row_t * row = row_buffer_insert(&editorConfig.current->editorRows, at);
+    if (row == NULL) {
+        editor_die("row_buffer_insert");
+    }
+    editorConfig.current->numberOfRows++;
+    editor_init_row(row, chars, length, mapped);
 }
 
 /// @brief Inserts a new row into the character buffer
@@ -817,105 +2334,287 @@ static void editor_insert_newline() {
 /// @param str The character buffer where the new row is added
 /// @param length The length of the new row
 static void editor_insert_row(uint32_t at, char * str, size_t length) {
-    if (at < 0 || at > editorConfig.numberOfRows) {
+    if (at < 0 || at > editorConfig.current->numberOfRows) {
         return;
     }
-    editorConfig.editorRows = realloc(editorConfig.editorRows, sizeof(editor_row_t) * (editorConfig.numberOfRows + 1));
-    memmove(&editorConfig.editorRows[at + 1], &editorConfig.editorRows[at],
-            sizeof(editor_row_t) * (editorConfig.numberOfRows - at));
+    editor_row_t * row = row_buffer_insert(&editorConfig.current->editorRows, at);
+    if (row == NULL) {
+        editor_die("row_buffer_insert");
+    }
+    editorConfig.current->numberOfRows++;
 
-    for (int32_t j = at + 1; j <= editorConfig.numberOfRows; j++) {
-        editorConfig.editorRows[j].index++;
+    row->size = length;
+    row->chars = malloc(length + 1);
+    memcpy(row->chars, str, length);
+    row->chars[length] = '\0';
+
+    row->renderSize = 0;
+    row->render = NULL;
+    row->highLightRuns = NULL;
+    row->highLightRunCount = 0;
+    row->highLightCursor = (highlight_runs_cursor_t){0, 0};
+    row->columnMap = NULL;
+    row->lastUse = 0;
+    row->mapped = row->renderAliased = row->shared = false;
+
+    // The row following the new row was highlighted based on the state of the previous row
+    row->hightLightOpenComment = at > 0 && editor_get_row(at - 1)->hightLightOpenComment;
+    if (at < editorConfig.current->syntaxValidRows) {
+        editorConfig.current->syntaxValidRows++;
+        editorConfig.current->syntaxConsistentRows++;
+    } else if (at < editorConfig.current->syntaxConsistentRows) {
+        editorConfig.current->syntaxConsistentRows = at;
     }
 
-    editorConfig.editorRows[at].index = at;
+    editor_update_row(at);
+
+    editorConfig.current->unsavedChanges = true;
+}
 
-    editorConfig.editorRows[at].size = length;
-    editorConfig.editorRows[at].chars = malloc(length + 1);
-    memcpy(editorConfig.editorRows[at].chars, str, length);
-    editorConfig.editorRows[at].chars[length] = '\0';
+/// @brief Marks the multiline comment state of a row and all the following rows
+/// as unknown, because the state of the previous row changed
+/// @param at The index of the row where the state is unknown
+/// @details The rows after it are still consistent to each other, so they are
+/// up to date again, once the row ends in the same state as before
+static void editor_invalidate_syntax(uint32_t at) {
+    if (at < editorConfig.current->syntaxValidRows) {
+        editorConfig.current->syntaxConsistentRows = editorConfig.current->syntaxValidRows;
+        editorConfig.current->syntaxValidRows = at;
+    }
+}
 
-    editorConfig.editorRows[at].renderSize = 0;
-    editorConfig.editorRows[at].render = NULL;
-    editorConfig.editorRows[at].highLight = NULL;
+/// @brief Determines whether the work of the editor is measured, because the
+/// measurements are shown or traced
+/// @return true if the work is measured, false if not
+static inline bool editor_is_profiling() {
+    return editorConfig.hudVisible || editorConfig.traceFile;
+}
 
-    editorConfig.editorRows[at].hightLightOpenComment = false;
+/// @brief Maps a regular file into memory and creates a row for every line
+/// without copying it
+/// @param fileDescriptor The file descriptor of the opened file
+/// @param fileSize The size of the file
+/// @return true if the file was mapped, false if not
+/// @details Large files are split into ranges, that are processed by a thread
+/// each. The threads count the lines of their range first, then the rows of
+/// all lines are inserted at once and the threads fill in the rows of their
+/// range
+static bool editor_load_mapped(int fileDescriptor, size_t fileSize) {
+    char * mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunkCount = fileSize / PARALLEL_LOAD_MINIMUM_CHUNK_SIZE;
+    if (processorCount > 0 && chunkCount > (size_t)processorCount) {
+        chunkCount = processorCount;
+    }
+    if (chunkCount > PARALLEL_MAXIMUM_THREADS) {
+        chunkCount = PARALLEL_MAXIMUM_THREADS;
+    }
+    if (chunkCount == 0) {
+        chunkCount = 1;
+    }
+    line_split_chunk_t chunks[PARALLEL_MAXIMUM_THREADS];
+    for (size_t t = 0; t < chunkCount; t++) {
+        chunks[t] = (line_split_chunk_t){mapping, fileSize, fileSize * t / chunkCount,
+                                         fileSize * (t + 1) / chunkCount, 0, NULL};
+    }
+    editor_run_parallel(editor_count_lines_chunk, chunks, sizeof(line_split_chunk_t), (uint32_t)chunkCount);
+    size_t rowCount = 0;
+    for (size_t t = 0; t < chunkCount; t++) {
+        rowCount += chunks[t].rowCount;
+    }
+    uint32_t at = editorConfig.current->numberOfRows;
+    if (rowCount > UINT32_MAX - at) {
+        munmap(mapping, fileSize);
+        return false;
+    }
+    editor_row_t * rows = row_buffer_insert_range(&editorConfig.current->editorRows, at, (uint32_t)rowCount);
+    if (rows == NULL) {
+        editor_die("row_buffer_insert_range");
+    }
+    for (size_t t = 0; t < chunkCount; t++) {
+        chunks[t].rows = rows;
+        rows += chunks[t].rowCount;
+    }
+    editor_run_parallel(editor_split_lines_chunk, chunks, sizeof(line_split_chunk_t), (uint32_t)chunkCount);
+    editorConfig.current->numberOfRows += (uint32_t)rowCount;
+    editorConfig.current->mapping = mapping;
+    editorConfig.current->mappingLength = fileSize;
+    editorConfig.current->mappingFileDescriptor = fileDescriptor;
+    return true;
+}
 
-    editor_update_row(&editorConfig.editorRows[at]);
+/// @brief Reads a file in blocks and creates a row for every line, that is
+/// stored in the row arena
+/// @param fileDescriptor The file descriptor of the opened file
+/// @details The lines are copied from the block into the row arena directly,
+/// only a line that continues in the next block is moved to the front of the
+/// block
+static void editor_load_stream(int fileDescriptor) {
+    size_t capacity = STREAM_READ_SIZE;
+    char * buffer = malloc(capacity);
+    if (buffer == NULL) {
+        return;
+    }
+    size_t length = 0;
+    // The first bytes of the buffer were searched for a line break already
+    size_t searched = 0;
+    bool endOfFile = false;
+    while (!endOfFile) {
+        if (length == capacity) {
+            // The line does not fit into the buffer
+            char * grown = realloc(buffer, capacity * 2);
+            if (grown == NULL) {
+                break;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t bytesRead = read(fileDescriptor, &buffer[length], capacity - length);
+        if (bytesRead == -1 && errno == EINTR) {
+            continue;
+        }
+        endOfFile = bytesRead <= 0;
+        length += bytesRead > 0 ? (size_t)bytesRead : 0;
+        char * bufferEnd = buffer + length;
+        char * lineStart = buffer;
+        char * searchStart = buffer + searched;
+        while (lineStart < bufferEnd) {
+            char * lineEnd = memchr(searchStart, '\n', bufferEnd - searchStart);
+            if (!lineEnd && !endOfFile) {
+                break;
+            }
+            char * nextLine = lineEnd ? lineEnd + 1 : bufferEnd;
+            if (!lineEnd) {
+                lineEnd = bufferEnd;
+            }
+            while (lineEnd > lineStart && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            char * chars = row_arena_store(&editorConfig.current->rowArena, lineStart, lineEnd - lineStart);
+            if (chars == NULL) {
+                editor_die("row_arena_store");
+            }
+            editor_append_loaded_row(chars, lineEnd - lineStart, true);
+            lineStart = searchStart = nextLine;
+        }
+        length = bufferEnd - lineStart;
+        memmove(buffer, lineStart, length);
+        searched = length;
+    }
+    free(buffer);
+}
 
-    editorConfig.numberOfRows++;
-    editorConfig.unsavedChanges = true;
+/// @brief Marks the line the cursor is currently positioned in as the start of
+/// the range of lines, that is yanked or deleted next
+/// @details Marking the same line again removes the mark
+static void editor_mark_line() {
+    editor_buffer_t * buffer = editorConfig.current;
+    if (buffer->marked && buffer->markRow == buffer->cursorCurrentY) {
+        buffer->marked = false;
+        editor_set_status_message("Mark removed");
+        return;
+    }
+    buffer->marked = true;
+    buffer->markRow = buffer->cursorCurrentY;
+    editor_set_status_message("Mark set, Ctrl-Y yanks and Ctrl-D deletes the lines up to the cursor");
 }
 
-/// @brief Determines whether a character is a seperator
-/// @param c The character that is evaluated
-/// @return true if the character is a seperator, false if not
-/// @details A seperator can be for example: a file, group, record, unit or
-/// information seperator
-static inline bool editor_is_separator(uint32_t c) {
-    return isspace(c) || c == '\0' || strchr(",.()+-/*=~%<>[];", c) != NULL;
+/// @brief Determines the rows between the mark and the cursor and removes the
+/// mark
+/// @param begin Is set to the index of the first row
+/// @param end Is set to the index of the row after the last row
+/// @return true if the range contains rows, false if not
+/// @details Without a mark the range is the row of the cursor
+static bool editor_marked_rows(uint32_t * begin, uint32_t * end) {
+    editor_buffer_t * buffer = editorConfig.current;
+    uint32_t first = buffer->cursorCurrentY;
+    uint32_t last = buffer->cursorCurrentY;
+    if (buffer->marked) {
+        // Rows might have been deleted since the mark was set
+        uint32_t mark = buffer->markRow < buffer->numberOfRows ? buffer->markRow : buffer->numberOfRows;
+        first = mark < first ? mark : first;
+        last = mark > last ? mark : last;
+        buffer->marked = false;
+    }
+    if (last >= buffer->numberOfRows) {
+        if (!buffer->numberOfRows || first >= buffer->numberOfRows) {
+            return false;
+        }
+        last = buffer->numberOfRows - 1;
+    }
+    *begin = first;
+    *end = last + 1;
+    return true;
 }
 
 /// @brief Moves the cursor based on the input
 /// @param key The key that was pressed
 static void editor_move_cursor(uint32_t key) {
-    editor_row_t * row = (editorConfig.cursorCurrentY >= editorConfig.numberOfRows)
+    editor_row_t * row = (editorConfig.current->cursorCurrentY >= editorConfig.current->numberOfRows)
                              ? NULL
-                             : &editorConfig.editorRows[editorConfig.cursorCurrentY];
+                             : editor_get_row(editorConfig.current->cursorCurrentY);
     switch (key) {
     case ARROW_LEFT:
-        if (editorConfig.cursorCurrentX != 0) {
-            editorConfig.cursorCurrentX--;
-        } else if (editorConfig.cursorCurrentY > 0) {
+        if (editorConfig.current->cursorCurrentX != 0) {
+            editorConfig.current->cursorCurrentX--;
+        } else if (editorConfig.current->cursorCurrentY > 0) {
             // Jump to the end of the previous line
-            editorConfig.cursorCurrentY--;
-            editorConfig.cursorCurrentX = editorConfig.editorRows[editorConfig.cursorCurrentY].size;
+            editorConfig.current->cursorCurrentY--;
+            editorConfig.current->cursorCurrentX = editor_get_row(editorConfig.current->cursorCurrentY)->size;
         }
         break;
     case ARROW_RIGHT:
-        if (row && editorConfig.cursorCurrentX < row->size) {
-            editorConfig.cursorCurrentX++;
-        } else if (row && editorConfig.cursorCurrentX == row->size) {
+        if (row && editorConfig.current->cursorCurrentX < row->size) {
+            editorConfig.current->cursorCurrentX++;
+        } else if (row && editorConfig.current->cursorCurrentX == row->size) {
             // Jump to the beginning of the next line
-            editorConfig.cursorCurrentY++;
+            editorConfig.current->cursorCurrentY++;
             // The next line beginns after the line numbers
-            editorConfig.cursorCurrentX = 0;
+            editorConfig.current->cursorCurrentX = 0;
         }
         break;
     case ARROW_UP:
-        if (editorConfig.cursorCurrentY != 0) {
-            editorConfig.cursorCurrentY--;
+        if (editorConfig.current->cursorCurrentY != 0) {
+            editorConfig.current->cursorCurrentY--;
         }
         break;
     case ARROW_DOWN:
-        if (editorConfig.cursorCurrentY < editorConfig.numberOfRows) {
-            editorConfig.cursorCurrentY++;
+        if (editorConfig.current->cursorCurrentY < editorConfig.current->numberOfRows) {
+            editorConfig.current->cursorCurrentY++;
         }
         break;
     }
-    row = (editorConfig.cursorCurrentY >= editorConfig.numberOfRows)
+    row = (editorConfig.current->cursorCurrentY >= editorConfig.current->numberOfRows)
               ? NULL
-              : &editorConfig.editorRows[editorConfig.cursorCurrentY];
+              : editor_get_row(editorConfig.current->cursorCurrentY);
     int rowlen = row ? row->size : 0;
-    if (editorConfig.cursorCurrentX > rowlen) {
-        editorConfig.cursorCurrentX = rowlen;
+    if (editorConfig.current->cursorCurrentX > rowlen) {
+        editorConfig.current->cursorCurrentX = rowlen;
+    }
+    // The cursor is never placed inside of a UTF-8 sequence
+    while (row && editorConfig.current->cursorCurrentX > 0 && editorConfig.current->cursorCurrentX < row->size &&
+           (row->chars[editorConfig.current->cursorCurrentX] & 0xc0) == 0x80) {
+        editorConfig.current->cursorCurrentX += key == ARROW_RIGHT ? 1 : -1;
     }
 }
 
 /// @brief Opens another file in the editor
 static void editor_open_file() {
-    uint32_t savedCurrentX = editorConfig.cursorCurrentX;
-    uint32_t savedCurrentY = editorConfig.cursorCurrentY;
-    uint32_t savedColumnOffset = editorConfig.columnOffset;
-    uint32_t savedRowOffset = editorConfig.rowOffset;
-    char * query = editor_prompt("Open: %s (Use ESC/Enter)", editor_open_file_callback);
+    uint32_t savedCurrentX = editorConfig.current->cursorCurrentX;
+    uint32_t savedCurrentY = editorConfig.current->cursorCurrentY;
+    uint32_t savedColumnOffset = editorConfig.current->columnOffset;
+    uint32_t savedRowOffset = editorConfig.current->rowOffset;
+    char * query = editor_prompt("Open: %s (Use ESC/Enter)", editor_open_file_callback, false);
     if (query) {
         free(query);
     } else {
-        editorConfig.cursorCurrentX = savedCurrentX;
-        editorConfig.cursorCurrentY = savedCurrentY;
-        editorConfig.columnOffset = savedColumnOffset;
-        editorConfig.rowOffset = savedRowOffset;
+        editorConfig.current->cursorCurrentX = savedCurrentX;
+        editorConfig.current->cursorCurrentY = savedCurrentY;
+        editorConfig.current->columnOffset = savedColumnOffset;
+        editorConfig.current->rowOffset = savedRowOffset;
     }
 }
 
@@ -926,20 +2625,23 @@ static void editor_open_file_callback(char * query, uint32_t key) {
     if (key != '\r') {
         return;
     }
-    if (editorConfig.unsavedChanges) {
-        editor_set_status_message("Can not open a new file, while currently opened "
-                                  "file has some unsaved changes");
-        return;
-    }
-    editor_initialize(editorConfig.config);
     editor_open(query);
 }
 
+/// @brief Gets the current time of the monotonic clock
+/// @return The current time in nanoseconds
+static uint64_t editor_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
 /// @brief Opens the editor prompt
 /// @param prompt The message that is displayed by the prompt
 /// @param callback The callback of the prompt
+/// @param allowEmpty Determines whether an empty input can be confirmed
 /// @return NULL if the prompt was cancelled, otherwise a pointer to the input
-static char * editor_prompt(char * prompt, void (*callback)(char *, uint32_t)) {
+static char * editor_prompt(char * prompt, void (*callback)(char *, uint32_t), bool allowEmpty) {
     size_t bufsize = 128;
     char * buf = malloc(bufsize);
     size_t buflen = 0;
@@ -964,7 +2666,7 @@ static char * editor_prompt(char * prompt, void (*callback)(char *, uint32_t)) {
         }
         // Enter
         else if (c == '\r') {
-            if (buflen != 0) {
+            if (buflen != 0 || allowEmpty) {
                 if (callback) {
                     callback(buf, c);
                 }
@@ -986,73 +2688,350 @@ static char * editor_prompt(char * prompt, void (*callback)(char *, uint32_t)) {
     }
 }
 
-/// @brief Pastes the content that is stroed in the copy buffer at the current
-/// position of the curser
-static inline void editor_paste_line() {
-    if (editorConfig.copyBuffer.buffer && editorConfig.copyBuffer.length) {
-        editor_insert_row(editorConfig.cursorCurrentY, editorConfig.copyBuffer.buffer, editorConfig.copyBuffer.length);
+/// @brief Pastes the lines that are stored in the selected register above the
+/// line of the curser
+/// @details Several lines are copied into the row arena as a single block and
+/// their rows are inserted at once, without rendering them. Their multiline
+/// comment state is determined once it is needed, or in parallel after the next
+/// frame if there are many of them
+static void editor_paste_lines() {
+    copy_buffer_t const * copyBuffer = &editorConfig.registers[editorConfig.selectedRegister];
+    editorConfig.selectedRegister = 0;
+    editor_buffer_t * buffer = editorConfig.current;
+    uint32_t at = buffer->cursorCurrentY < buffer->numberOfRows ? buffer->cursorCurrentY : buffer->numberOfRows;
+    if (copyBuffer->lineCount == 1) {
+        editor_insert_row(at, copyBuffer->buffer, copyBuffer->lineLengths[0]);
+        return;
+    }
+    if (copyBuffer->lineCount == 0) {
+        return;
+    }
+    char * chars = row_arena_store(&buffer->rowArena, copyBuffer->buffer, copyBuffer->length - 1);
+    editor_row_t * rows = chars ? row_buffer_insert_range(&buffer->editorRows, at, copyBuffer->lineCount) : NULL;
+    if (rows == NULL) {
+        editor_die("editor_paste_lines");
+    }
+    bool incomingComment = at > 0 && editor_get_row(at - 1)->hightLightOpenComment;
+    for (uint32_t i = 0; i < copyBuffer->lineCount; i++) {
+        editor_init_row(&rows[i], chars, copyBuffer->lineLengths[i], true);
+        rows[i].hightLightOpenComment = incomingComment;
+        chars += copyBuffer->lineLengths[i] + 1;
+    }
+    buffer->numberOfRows += copyBuffer->lineCount;
+    // The states of the new rows are unknown, so the rows after them are not consistent with them either
+    if (at < buffer->syntaxValidRows) {
+        buffer->syntaxValidRows = at;
+    }
+    if (at < buffer->syntaxConsistentRows) {
+        buffer->syntaxConsistentRows = at;
+    }
+    buffer->syntaxScanPending = true;
+    buffer->unsavedChanges = true;
+}
+
+/// @brief Reads the text that is pasted into the terminal and inserts it
+/// @details The text ends, once the terminal marks the end of the pasted text.
+/// If the end is not marked in time or the input was closed, the text that
+/// arrived so far is inserted
+static void editor_paste_text() {
+    static char const pasteEnd[] = "\x1b[201~";
+    append_buffer_t text;
+    append_buffer_init(&text);
+    size_t matched = 0;
+    uint32_t emptyReads = 0;
+    uint64_t deadline = 0;
+    while (matched < sizeof(pasteEnd) - 1) {
+        char c;
+        if (!editor_read_byte(&c)) {
+            uint64_t now = event_loop_now();
+            if (!emptyReads) {
+                deadline = now + PASTE_TIMEOUT;
+            }
+            if (now >= deadline || ++emptyReads > PASTE_MAXIMUM_EMPTY_READS) {
+                // The text was cut off, the bytes that looked like the end of the text are dropped
+                editor_set_status_message("The end of the pasted text is missing");
+                break;
+            }
+            // Timers and signals are handled while the rest of the text is awaited
+            editor_wait_for_input((int32_t)(deadline - now));
+            continue;
+        }
+        emptyReads = 0;
+        if (c == pasteEnd[matched]) {
+            matched++;
+            continue;
+        }
+        // The bytes that looked like the end of the text are part of it
+        append_buffer_append_string(&text, pasteEnd, matched);
+        matched = c == pasteEnd[0];
+        if (!matched) {
+            append_buffer_append_string(&text, &c, 1);
+        }
+    }
+    if (text.length) {
+        editor_insert_text(text.buffer, text.length);
+    }
+    append_buffer_free(&text);
+}
+
+/// @brief Gets a row and makes sure it's render buffer and syntax highlighting
+/// are up to date
+/// @param at The index of the row
+/// @return Pointer to the row, that is valid until rows are inserted or deleted
+static editor_row_t * editor_prepare_row(uint32_t at) {
+    editor_scan_syntax(at);
+    editor_row_t * row = editor_get_row(at);
+    if (row->render == NULL) {
+        editor_update_row(at);
+        editorConfig.derivedMemory += editor_row_derived_size(row);
+    } else if (at == editorConfig.current->syntaxValidRows) {
+        editor_update_syntax(at);
+    }
+    row->lastUse = editorConfig.frameNumber;
+    return row;
+}
+
+/// @brief Highlights rows again, after the multiline comment state of the row
+/// before them changed
+/// @param at The index of the first row that is highlighted again
+/// @details Only rows that are visible are highlighted right away. The
+/// propagation stops as soon as a row ends in the same state as before, at the
+/// first row that is not visible the remaining rows are marked as unknown and
+/// highlighted once they are needed.
+static void editor_propagate_syntax(uint32_t at) {
+    uint32_t viewportEnd = editorConfig.current->rowOffset + editorConfig.screenRows;
+    while (at < editorConfig.current->syntaxValidRows) {
+        editor_row_t * row = editor_get_row(at);
+        if (!row->render || at < editorConfig.current->rowOffset || at >= viewportEnd) {
+            editor_invalidate_syntax(at);
+            return;
+        }
+        bool insideComment = editor_highlight_row(row, at > 0 && editor_get_row(at - 1)->hightLightOpenComment);
+        if (insideComment == row->hightLightOpenComment) {
+            return;
+        }
+        row->hightLightOpenComment = insideComment;
+        at++;
+    }
+}
+
+/// @brief Adds the lines, that were appended to the followed files, to their
+/// rows
+/// @details The displayed file is not changed while it is searched, because
+/// the matches refer to its rows. The output of executed programs is watched
+/// again, once their output buffer is not searched anymore
+static void editor_poll_follow() {
+    editor_buffer_t * displayed = editorConfig.current;
+    bool following = false;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        if (buffer->executeFileDescriptor != -1) {
+            // The output, that was not watched while the buffer was searched, is watched again
+            event_loop_unwatch(&editorConfig.eventLoop, buffer->executeFileDescriptor);
+            if (buffer == displayed && editorConfig.searchIndex.query) {
+                following = true;
+            } else {
+                event_loop_watch(&editorConfig.eventLoop, buffer->executeFileDescriptor, editor_read_program_output);
+            }
+        }
+        if (buffer->followFileDescriptor == -1) {
+            continue;
+        }
+        following = true;
+        if (buffer == displayed && editorConfig.searchIndex.query) {
+            continue;
+        }
+        // The rows are changed through the displayed buffer
+        editorConfig.current = buffer;
+        if (editor_read_followed_file(buffer == displayed) && buffer == displayed) {
+            editorConfig.redrawPending = true;
+        }
+        editorConfig.current = displayed;
+    }
+    if (following) {
+        event_loop_start_timer(&editorConfig.eventLoop, editorConfig.followTimer, FOLLOW_POLL_INTERVAL);
+    }
+}
+
+/// @brief Checks whether the saves in the background of the opened files are
+/// completed, so the results are shown without waiting for input
+static void editor_poll_save() {
+    editor_buffer_t * displayed = editorConfig.current;
+    bool saving = false;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        if (!buffer->saveJob.running) {
+            continue;
+        }
+        // The save is completed through the displayed buffer
+        editorConfig.current = buffer;
+        if (editor_finish_save(false)) {
+            if (buffer != displayed) {
+                // The message names the file, because it is not displayed
+                char message[sizeof(editorConfig.statusMessage)];
+                snprintf(message, sizeof(message), "%s", editorConfig.statusMessage);
+                editor_set_status_message("%s: %s", buffer->fileName, message);
+            }
+            editorConfig.redrawPending = true;
+        } else {
+            saving = true;
+        }
+        editorConfig.current = displayed;
+    }
+    if (saving) {
+        event_loop_start_timer(&editorConfig.eventLoop, editorConfig.saveTimer, SAVE_POLL_INTERVAL);
     }
 }
 
 /// @brief Quits the editor
 static void editor_quit() {
+    // Saving might still fail, so the changes are only saved once the saves of all files are completed
+    editor_wait_for_save();
 
-    if (editorConfig.unsavedChanges && editorConfig.quitTimes > 0) {
-        editor_set_status_message("WARNING!!! File has unsaved changes. "
-                                  "Press Ctrl-Q %d more times to quit.",
-                                  editorConfig.quitTimes);
+    uint32_t unsavedFiles = 0;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        unsavedFiles += editorConfig.buffers[i]->unsavedChanges ? 1 : 0;
+    }
+    if (unsavedFiles && editorConfig.quitTimes > 0) {
+        if (editorConfig.current->unsavedChanges && unsavedFiles == 1) {
+            editor_set_status_message("WARNING!!! File has unsaved changes. "
+                                      "Press Ctrl-Q %d more times to quit.",
+                                      editorConfig.quitTimes);
+        } else {
+            editor_set_status_message("WARNING!!! %u files have unsaved changes. "
+                                      "Press Ctrl-Q %d more times to quit.",
+                                      unsavedFiles, editorConfig.quitTimes);
+        }
         editorConfig.quitTimes--;
         return;
     }
-    copy_buffer_free(&editorConfig.copyBuffer);
+    for (uint32_t i = 0; i < REGISTER_COUNT; i++) {
+        copy_buffer_free(&editorConfig.registers[i]);
+    }
     // Clears the screen when the editor is quit
-    write(STDOUT_FILENO, "\x1b[2J", 4);
-    write(STDOUT_FILENO, "\x1b[H", 3);
+    write(editorConfig.outputFileDescriptor, "\x1b[2J", 4);
+    write(editorConfig.outputFileDescriptor, "\x1b[H", 3);
+    event_loop_free(&editorConfig.eventLoop);
+    if (editorConfig.traceFile) {
+        fclose(editorConfig.traceFile);
+    }
     if (editorConfig.config) {
         free(editorConfig.config);
     }
     exit(0);
 }
 
+/// @brief Reads a single byte of input from the terminal
+/// @param byte Is set to the byte that was read
+/// @return true if a byte was read, false if no input arrived before the read
+/// timed out
+/// @details All the input that is available is read at once and buffered
+static bool editor_read_byte(char * byte) {
+    if (editorConfig.inputStart == editorConfig.inputEnd) {
+        ssize_t nread = read(editorConfig.inputFileDescriptor, editorConfig.input, sizeof(editorConfig.input));
+        if (nread == -1 && errno != EAGAIN) {
+            editor_die("read");
+        }
+        if (nread <= 0) {
+            return false;
+        }
+        editorConfig.inputStart = 0;
+        editorConfig.inputEnd = (uint32_t)nread;
+    }
+    *byte = editorConfig.input[editorConfig.inputStart++];
+    return true;
+}
+
+/// @brief Adds the lines, that were appended to the followed file of the opened
+/// buffer since it was read last, to the rows
+/// @param displayed Determines whether the buffer is displayed, so the rows on
+/// the screen are scrolled along with the dropped rows
+/// @return true if the rows were changed, false if not
+/// @details The new rows are rendered and highlighted once they are needed. A
+/// cursor on the last row stays on the last row. A file that was truncated is
+/// read from its start again
+static bool editor_read_followed_file(bool displayed) {
+    editor_buffer_t * buffer = editorConfig.current;
+    struct stat fileStatus;
+    if (fstat(buffer->followFileDescriptor, &fileStatus) == -1) {
+        return false;
+    }
+    bool changed = false;
+    bool unsavedChanges = buffer->unsavedChanges;
+    if (fileStatus.st_size < buffer->followOffset) {
+        // The rows of the previous contents of the file are gone, so they can not be saved anymore
+        editor_free_rows();
+        buffer->cursorCurrentX = buffer->cursorCurrentY = buffer->rowOffset = 0;
+        unsavedChanges = false;
+        buffer->followOffset = 0;
+        buffer->followPartialRow = false;
+        changed = true;
+    }
+    bool followCursor = buffer->cursorCurrentY + 1 >= buffer->numberOfRows;
+    uint32_t droppedRows = 0;
+    char chunk[FOLLOW_READ_SIZE];
+    ssize_t chunkLength;
+    while (buffer->followOffset < fileStatus.st_size &&
+           (chunkLength = pread(buffer->followFileDescriptor, chunk, sizeof(chunk), buffer->followOffset)) > 0) {
+        droppedRows += editor_append_followed_text(chunk, (size_t)chunkLength);
+        buffer->followOffset += chunkLength;
+        changed = true;
+    }
+    editor_follow_rows(droppedRows, followCursor, displayed);
+    buffer->unsavedChanges = unsavedChanges;
+    return changed;
+}
+
 /// @brief Reads a single character from the keyboard
 /// @return The character that was read
 static uint32_t editor_read_key() {
-    uint32_t nread;
     char c;
-    while ((nread = read(STDIN_FILENO, &c, 1)) != 1) {
-        if (nread == -1 && errno != EAGAIN) {
-            editor_die("read");
+    do {
+        // Timers and signals are handled while the editor waits for the user
+        while (editorConfig.inputStart == editorConfig.inputEnd && !editor_wait_for_input(-1)) {
         }
-    }
+    } while (!editor_read_byte(&c));
     if (c == '\x1b') {
         char seq[3];
-        if (read(STDIN_FILENO, &seq[0], 1) != 1) {
+        if (!editor_read_byte(&seq[0])) {
             return '\x1b';
         }
-        if (read(STDIN_FILENO, &seq[1], 1) != 1) {
+        if (!editor_read_byte(&seq[1])) {
             return '\x1b';
         }
         if (seq[0] == '[') {
             if (seq[1] >= '0' && seq[1] <= '9') {
-                if (read(STDIN_FILENO, &seq[2], 1) != 1) {
+                // The number of the key can consist of multiple digits
+                uint32_t number = seq[1] - '0';
+                if (!editor_read_byte(&seq[2])) {
                     return '\x1b';
                 }
+                while (seq[2] >= '0' && seq[2] <= '9' && number < 1000) {
+                    number = number * 10 + (seq[2] - '0');
+                    if (!editor_read_byte(&seq[2])) {
+                        return '\x1b';
+                    }
+                }
                 if (seq[2] == '~') {
-                    switch (seq[1]) {
-                    case '1':
+                    switch (number) {
+                    case 1:
                         return HOME_KEY;
-                    case '3':
+                    case 3:
                         return DEL_KEY;
-                    case '4':
+                    case 4:
                         return END_KEY;
-                    case '5':
+                    case 5:
                         return PAGE_UP;
-                    case '6':
+                    case 6:
                         return PAGE_DOWN;
-                    case '7':
+                    case 7:
                         return HOME_KEY;
-                    case '8':
+                    case 8:
                         return END_KEY;
+                    case 200:
+                        return PASTE_START;
+                    case 201:
+                        return PASTE_END;
                     }
                 }
             } else {
@@ -1085,17 +3064,356 @@ static uint32_t editor_read_key() {
     }
 }
 
+/// @brief Adds the output, that the executed programs wrote since it was read
+/// last, to the rows of their output buffers
+/// @details The displayed buffer is not changed while it is searched, because
+/// the matches refer to its rows. Its output is not watched meanwhile, the
+/// program waits once the pipe is full
+static void editor_read_program_output() {
+    editor_buffer_t * displayed = editorConfig.current;
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        if (buffer->executeFileDescriptor == -1) {
+            continue;
+        }
+        if (buffer == displayed && editorConfig.searchIndex.query) {
+            event_loop_unwatch(&editorConfig.eventLoop, buffer->executeFileDescriptor);
+            event_loop_start_timer(&editorConfig.eventLoop, editorConfig.followTimer, FOLLOW_POLL_INTERVAL);
+            continue;
+        }
+        // The rows are changed through the displayed buffer
+        editorConfig.current = buffer;
+        bool followCursor = buffer->cursorCurrentY + 1 >= buffer->numberOfRows;
+        bool unsavedChanges = buffer->unsavedChanges;
+        uint32_t droppedRows = 0;
+        size_t outputLength = 0;
+        char chunk[FOLLOW_READ_SIZE];
+        ssize_t chunkLength = 0;
+        // A program that writes faster than its output is read does not hold back the input
+        while (outputLength < EXECUTE_MAXIMUM_READ &&
+               (chunkLength = read(buffer->executeFileDescriptor, chunk, sizeof(chunk))) > 0) {
+            droppedRows += editor_append_followed_text(chunk, (size_t)chunkLength);
+            outputLength += (size_t)chunkLength;
+        }
+        editor_follow_rows(droppedRows, followCursor, buffer == displayed);
+        buffer->unsavedChanges = unsavedChanges;
+        editorConfig.current = displayed;
+        if (chunkLength == 0 || (chunkLength == -1 && errno != EAGAIN && errno != EINTR)) {
+            // The program closed its output, usually because it exited
+            event_loop_unwatch(&editorConfig.eventLoop, buffer->executeFileDescriptor);
+            close(buffer->executeFileDescriptor);
+            buffer->executeFileDescriptor = -1;
+            if (buffer->executeProcess) {
+                editor_reap_programs();
+            } else {
+                editor_finish_program(buffer);
+            }
+        }
+        if (buffer == displayed) {
+            editorConfig.redrawPending = true;
+        }
+    }
+}
+
+/// @brief Determines the exit status of the executed programs, that exited
+static void editor_reap_programs() {
+    for (uint32_t i = 0; i < editorConfig.bufferCount; i++) {
+        editor_buffer_t * buffer = editorConfig.buffers[i];
+        if (buffer->executeProcess &&
+            waitpid(buffer->executeProcess, &buffer->executeStatus, WNOHANG) == buffer->executeProcess) {
+            buffer->executeProcess = 0;
+            editor_finish_program(buffer);
+            editorConfig.redrawPending = true;
+        }
+    }
+}
+
+/// @brief Adds a row that was highlighted to the measurements of the current
+/// frame
+/// @param start Point in time the row was started to be highlighted in
+/// nanoseconds
+static void editor_record_highlight(uint64_t start) {
+    editorConfig.frameStatistics.highlightTime += editor_now() - start;
+    editorConfig.frameStatistics.rowsHighlighted++;
+}
+
+/// @brief Replaces all occurences of a word in the currently opened file, an
+/// empty replacement deletes them
+/// @details Every affected row is rewritten in a single pass and its render
+/// buffer and highlighting are created again once it is displayed. The
+/// multiline comment state is determined again once for all rows. Large
+/// amounts of matches are replaced in batches by several threads, the progress
+/// is shown after every batch
+static void editor_replace_all() {
+    char * query = editor_prompt("Replace: %s (ESC to cancel)", NULL, false);
+    if (query == NULL) {
+        editor_set_status_message("Replace aborted");
+        return;
+    }
+    char * replacement = editor_prompt("Replace with: %s (ESC to cancel)", NULL, true);
+    if (replacement == NULL) {
+        free(query);
+        editor_set_status_message("Replace aborted");
+        return;
+    }
+    editor_buffer_t * buffer = editorConfig.current;
+    // The matches are not highlighted while they are replaced, so they are not stored in the search index of the editor
+    search_index_t index;
+    search_index_init(&index);
+    if (!search_index_update(&index, &buffer->editorRows, query, strlen(query))) {
+        editor_set_status_message("Not enough memory to search for %s", query);
+    } else if (index.count == 0) {
+        editor_set_status_message("No occurences of %s found", query);
+    } else {
+        // The rows after the first replaced row might end in different states
+        uint32_t firstRow = index.matches[0].row;
+        if (firstRow < buffer->syntaxValidRows) {
+            buffer->syntaxValidRows = firstRow;
+        }
+        if (firstRow < buffer->syntaxConsistentRows) {
+            buffer->syntaxConsistentRows = firstRow;
+        }
+        buffer->syntaxScanPending = true;
+        long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+        uint32_t replaced = 0, replacedRows = 0;
+        for (uint32_t batchBegin = 0; batchBegin < index.count;) {
+            uint32_t batchEnd = index.count - batchBegin > REPLACE_BATCH_SIZE ? batchBegin + REPLACE_BATCH_SIZE
+                                                                             : index.count;
+            while (batchEnd < index.count && index.matches[batchEnd].row == index.matches[batchEnd - 1].row) {
+                batchEnd++;
+            }
+            uint32_t chunkCount = (batchEnd - batchBegin) / PARALLEL_REPLACE_MINIMUM_CHUNK_SIZE;
+            if (processorCount > 0 && chunkCount > (uint32_t)processorCount) {
+                chunkCount = processorCount;
+            }
+            if (chunkCount > PARALLEL_MAXIMUM_THREADS) {
+                chunkCount = PARALLEL_MAXIMUM_THREADS;
+            }
+            if (chunkCount == 0) {
+                chunkCount = 1;
+            }
+            replace_chunk_t chunks[PARALLEL_MAXIMUM_THREADS];
+            uint32_t chunkBegin = batchBegin;
+            for (uint32_t t = 0; t < chunkCount; t++) {
+                uint32_t chunkEnd = batchBegin + (uint32_t)((uint64_t)(batchEnd - batchBegin) * (t + 1) / chunkCount);
+                // The matches of a row are replaced by the same thread
+                while (chunkEnd < batchEnd && chunkEnd > chunkBegin &&
+                       index.matches[chunkEnd].row == index.matches[chunkEnd - 1].row) {
+                    chunkEnd++;
+                }
+                if (chunkEnd < chunkBegin) {
+                    chunkEnd = chunkBegin;
+                }
+                chunks[t] = (replace_chunk_t){index.matches,
+                                              chunkBegin,
+                                              chunkEnd,
+                                              query,
+                                              (uint32_t)index.queryLength,
+                                              replacement,
+                                              (uint32_t)strlen(replacement),
+                                              NULL,
+                                              0,
+                                              0};
+                chunkBegin = chunkEnd;
+            }
+            editor_run_parallel(editor_replace_chunk, chunks, sizeof(replace_chunk_t), chunkCount);
+            // The old character buffers are freed by the main thread, a save in progress might still write them
+            for (uint32_t t = 0; t < chunkCount; t++) {
+                if (chunks[t].rows == NULL) {
+                    editor_die("editor_replace_chunk");
+                }
+                for (uint32_t i = 0; i < chunks[t].rowCount; i++) {
+                    editor_row_t * row = editor_get_row(chunks[t].rows[i].row);
+                    editor_release_row(row);
+                    if (row->shared) {
+                        if (!save_job_defer_free(&buffer->saveJob, row->chars)) {
+                            editor_die("save_job_defer_free");
+                        }
+                    } else if (!row->mapped) {
+                        free(row->chars);
+                    }
+                    row->chars = chunks[t].rows[i].chars;
+                    row->size = chunks[t].rows[i].size;
+                    row->mapped = row->shared = false;
+                }
+                replaced += chunks[t].replaced;
+                replacedRows += chunks[t].rowCount;
+                free(chunks[t].rows);
+            }
+            batchBegin = batchEnd;
+            if (batchBegin < index.count) {
+                editor_set_status_message("Replacing %s... %u%%", query,
+                                          (uint32_t)((uint64_t)batchBegin * 100 / index.count));
+                editor_refresh_screen();
+            }
+        }
+        if (buffer->cursorCurrentY < buffer->numberOfRows &&
+            buffer->cursorCurrentX > editor_get_row(buffer->cursorCurrentY)->size) {
+            buffer->cursorCurrentX = editor_get_row(buffer->cursorCurrentY)->size;
+        }
+        buffer->unsavedChanges = true;
+        editor_set_status_message("Replaced %u occurences of %s in %u rows", replaced, query, replacedRows);
+    }
+    search_index_free(&index);
+    free(query);
+    free(replacement);
+}
+
+/// @brief Replaces the matches of a range with new character buffers for their
+/// rows
+/// @param argument The replace_chunk_t whose matches are replaced
+/// @return NULL
+/// @details The rows themselves are not modified, every row is written into a
+/// new buffer in a single pass
+static void * editor_replace_chunk(void * argument) {
+    replace_chunk_t * chunk = argument;
+    chunk->rows = malloc(sizeof(replaced_row_t) * (chunk->end - chunk->begin + 1));
+    if (chunk->rows == NULL) {
+        return NULL;
+    }
+    for (uint32_t i = chunk->begin; i < chunk->end;) {
+        uint32_t at = chunk->matches[i].row;
+        editor_row_t const * row = editor_get_row(at);
+        // Matches can overlap, a match that starts inside of a replaced match is kept
+        uint32_t rowEnd = i, count = 0, next = 0;
+        for (; rowEnd < chunk->end && chunk->matches[rowEnd].row == at; rowEnd++) {
+            if (chunk->matches[rowEnd].column >= next) {
+                count++;
+                next = chunk->matches[rowEnd].column + chunk->queryLength;
+            }
+        }
+        size_t size = (size_t)row->size - (size_t)count * chunk->queryLength + (size_t)count * chunk->replacementLength;
+        char * chars = malloc(size + 1);
+        if (chars == NULL) {
+            for (uint32_t r = 0; r < chunk->rowCount; r++) {
+                free(chunk->rows[r].chars);
+            }
+            free(chunk->rows);
+            chunk->rows = NULL;
+            return NULL;
+        }
+        size_t written = 0;
+        uint32_t copied = 0;
+        next = 0;
+        for (uint32_t m = i; m < rowEnd; m++) {
+            uint32_t column = chunk->matches[m].column;
+            if (column < next) {
+                continue;
+            }
+            memcpy(&chars[written], &row->chars[copied], column - copied);
+            written += column - copied;
+            memcpy(&chars[written], chunk->replacement, chunk->replacementLength);
+            written += chunk->replacementLength;
+            copied = next = column + chunk->queryLength;
+        }
+        memcpy(&chars[written], &row->chars[copied], row->size - copied);
+        chars[size] = '\0';
+        chunk->rows[chunk->rowCount++] = (replaced_row_t){at, (uint32_t)size, chars};
+        chunk->replaced += count;
+        i = rowEnd;
+    }
+    return NULL;
+}
+
+/// @brief Makes sure the buffer that is used to highlight a row fits a given
+/// amount of characters
+/// @param length The amount of characters
+/// @return The buffer
+static unsigned char * editor_reserve_highlight_columns(uint32_t length) {
+    // Empty rows need a buffer as well, the highlighting of zero characters is still written
+    if (length == 0) {
+        length = 1;
+    }
+    if (length > editorConfig.highLightColumnsCapacity) {
+        unsigned char * highLightColumns = realloc(editorConfig.highLightColumns, length);
+        if (highLightColumns == NULL) {
+            editor_die("realloc");
+        }
+        editorConfig.highLightColumns = highLightColumns;
+        editorConfig.highLightColumnsCapacity = length;
+    }
+    return editorConfig.highLightColumns;
+}
+
+/// @brief Adjusts the layout of the editor to the new size of the terminal
+/// @details Only the window size is determined again, the whole screen is
+/// redrawn with the next frame
+static void editor_resize() {
+    uint32_t rows, columns;
+    if (editor_get_window_size(&rows, &columns) == -1) {
+        return;
+    }
+    // Make room for status bar and message bar
+    editorConfig.screenRows = rows > 2 ? rows - 2 : 1;
+    editorConfig.screenColumns = columns;
+    frame_cache_invalidate(&editorConfig.frameCache);
+    editorConfig.redrawPending = true;
+}
+
+/// @brief Determines the resident memory of the editor
+/// @return The resident memory in bytes, or the peak resident memory if the
+/// current one is not available
+static size_t editor_resident_memory() {
+    // The second field of statm is the amount of resident pages
+    int fileDescriptor = open("/proc/self/statm", O_RDONLY);
+    if (fileDescriptor != -1) {
+        char statm[128];
+        ssize_t length = read(fileDescriptor, statm, sizeof(statm) - 1);
+        close(fileDescriptor);
+        unsigned long size, resident;
+        if (length > 0) {
+            statm[length] = '\0';
+            if (sscanf(statm, "%lu %lu", &size, &resident) == 2) {
+                return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+            }
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
 /// @brief Appends a character sequence to an editor row
-/// @param row The row where the character sequence is appended
+/// @param rowIndex The index of the row where the character sequence is appended
 /// @param str The character sequence that is appended
 /// @param length The length of the character sequence
-static void editor_row_append_string(editor_row_t * row, char * str, size_t length) {
+static void editor_row_append_string(uint32_t rowIndex, char * str, size_t length) {
+    editor_row_t * row = editor_get_row(rowIndex);
+    editor_row_detach(row);
     row->chars = realloc(row->chars, row->size + length + 1);
     memcpy(&row->chars[row->size], str, length);
     row->size += length;
     row->chars[row->size] = '\0';
-    editor_update_row(row);
-    editorConfig.unsavedChanges = true;
+    editor_update_row(rowIndex);
+    editorConfig.current->unsavedChanges = true;
+}
+
+/// @brief Gets the column map of a row, it is created if the row is long
+/// enough to need one
+/// @param row The row
+/// @return The column map or NULL if the row is short
+static column_map_t const * editor_row_column_map(editor_row_t * row) {
+    if (row->columnMap == NULL && row->size > COLUMN_MAP_INTERVAL) {
+        // Without memory the positions are determined from the start of the row
+        row->columnMap = column_map_create(row->chars, row->size, editorConfig.config->tabStopSize);
+    }
+    return row->columnMap;
+}
+
+/// @brief Appends a character sequence to a row, without rendering it
+/// @param row The row where the character sequence is appended, it must own
+/// it's character buffer
+/// @param str The character sequence that is appended
+/// @param length The length of the character sequence
+static void editor_row_append_unrendered(editor_row_t * row, char const * str, size_t length) {
+    char * chars = realloc(row->chars, row->size + length + 1);
+    if (chars == NULL) {
+        editor_die("realloc");
+    }
+    memcpy(&chars[row->size], str, length);
+    row->size += length;
+    chars[row->size] = '\0';
+    row->chars = chars;
 }
 
 /// @brief Translates the a horizontal coordinate from the underlying character
@@ -1105,146 +3423,526 @@ static void editor_row_append_string(editor_row_t * row, char * str, size_t leng
 /// character pointer
 /// @return The coordinate tranlated to a render coordinate
 static uint32_t editor_row_cx_to_rx(editor_row_t * row, uint32_t cursorCurrentX) {
-    uint32_t renderX = 0;
-    uint32_t j;
-    for (j = 0; j < cursorCurrentX; j++) {
-        if (row->chars[j] == '\t') {
-            renderX += (editorConfig.config->tabStopSize - 1) - (renderX % editorConfig.config->tabStopSize);
-        }
-        renderX++;
-    }
-    return renderX;
+    return editor_row_find_character(row, cursorCurrentX).render;
 }
 
 /// @brief Deletes a single character from an editor row
-/// @param row The row where the character is deleted
+/// @param rowIndex The index of the row where the character is deleted
 /// @param at The index of the character in the underlying character buffer of
 /// the editor row
-static void editor_row_delete_character(editor_row_t * row, uint32_t at) {
+static void editor_row_delete_character(uint32_t rowIndex, uint32_t at) {
+    editor_row_t * row = editor_get_row(rowIndex);
     if (at < 0 || at >= row->size) {
         return;
     }
+    editor_row_detach(row);
+    char deletedCharacter = row->chars[at];
     memmove(&row->chars[at], &row->chars[at + 1], row->size - at);
     row->size--;
-    editor_update_row(row);
-    editorConfig.unsavedChanges = true;
+    if (!editor_row_patch(rowIndex, at, -1, deletedCharacter)) {
+        editor_update_row(rowIndex);
+    }
+    editorConfig.current->unsavedChanges = true;
+}
+
+/// @brief Determines the memory of the data of a row, that is derived from its
+/// underlying character buffer
+/// @param row The row
+/// @return The amount of bytes of the render buffer, the syntax highlighting and
+/// the column map of the row
+static inline size_t editor_row_derived_size(editor_row_t const * row) {
+    size_t size = row->highLightRunCount * sizeof(highlight_run_t);
+    if (row->render && !row->renderAliased) {
+        size += row->renderSize + 1;
+    }
+    if (row->columnMap) {
+        size += sizeof(column_map_t) + row->columnMap->count * sizeof(column_map_position_t);
+    }
+    return size;
+}
+
+/// @brief Copies the underlying character buffer of a row, that points into the
+/// memory mapped file or is still written by a save in progress, so it can be
+/// modified
+/// @param row The row that is detached from the memory mapped file or the save
+static void editor_row_detach(editor_row_t * row) {
+    if (!row->mapped && !row->shared) {
+        return;
+    }
+    char * chars = malloc(row->size + 1);
+    if (chars == NULL) {
+        editor_die("malloc");
+    }
+    memcpy(chars, row->chars, row->size);
+    chars[row->size] = '\0';
+    // The save in progress still writes the old buffer, so it is freed once the save is completed
+    if (row->shared && !save_job_defer_free(&editorConfig.current->saveJob, row->chars)) {
+        editor_die("save_job_defer_free");
+    }
+    row->chars = chars;
+    row->mapped = row->shared = false;
+    if (row->renderAliased) {
+        row->render = chars;
+    }
 }
 
 /// @brief Inserts a single character in an editor row
-/// @param row The row where the character is inserted
+/// @param rowIndex The index of the row where the character is inserted
 /// @param at The index where the character is inserted
 /// @param c The character that is inserted
-static void editor_row_insert_character(editor_row_t * row, uint32_t at, uint32_t c) {
+static void editor_row_insert_character(uint32_t rowIndex, uint32_t at, uint32_t c) {
+    editor_row_t * row = editor_get_row(rowIndex);
     if (at < 0 || at > row->size) {
         at = row->size;
     }
+    editor_row_detach(row);
     row->chars = realloc(row->chars, row->size + 2);
     memmove(&row->chars[at + 1], &row->chars[at], row->size - at + 1);
     row->size++;
     row->chars[at] = c;
-    editor_update_row(row);
-    editorConfig.unsavedChanges = true;
+    if (!editor_row_patch(rowIndex, at, 1, c)) {
+        editor_update_row(rowIndex);
+    }
+    editorConfig.current->unsavedChanges = true;
 }
 
-/// @brief Translates a render coordinate into a coordinate of the underlying
-/// character buffer
-/// @param row The row where the coordinates are translated
-/// @param renderX The coordinate in the renderer
-/// @return The coordinate in the underlying character buffer
-static uint32_t editor_row_rx_to_cx(editor_row_t * row, uint32_t renderX) {
-    uint32_t cur_rx = 0;
-    uint32_t cursorCurrentX;
-    for (cursorCurrentX = 0; cursorCurrentX < row->size; cursorCurrentX++) {
-        if (row->chars[cursorCurrentX] == '\t') {
-            cur_rx += (editorConfig.config->tabStopSize - 1) - (cur_rx % editorConfig.config->tabStopSize);
+/// @brief Updates the render buffer and the syntax highlighting of a row after a
+/// single character was inserted or deleted, without processing the whole row
+/// @param rowIndex The index of the row that was modified
+/// @param at The index of the character in the underlying character buffer
+/// @param delta 1 if the character was inserted, -1 if it was deleted
+/// @param character The character that was inserted or deleted
+/// @return true if the row was updated, false if it needs to be updated
+/// completely
+/// @details The render buffer is only changed up to the next tab, the rest of
+/// it is shifted. The lexer starts at the closest separator before the
+/// modification, that can not be part of a longer token, and stops as soon as
+/// it reaches the same state as before. Only the highlighting and the column
+/// checkpoints around the modification are processed, so the work does not
+/// depend on the length of the row unless the highlighting changes beyond the
+/// margin around the modification
+static bool editor_row_patch(uint32_t rowIndex, uint32_t at, int32_t delta, char character) {
+    editor_row_t * row = editor_get_row(rowIndex);
+    // Bytes of UTF-8 sequences can change the width of the characters around them
+    uint32_t next = delta > 0 ? at + 1 : at;
+    if (character == '\t' || (character & 0x80) || (at > 0 && (row->chars[at - 1] & 0x80)) ||
+        (next < row->size && (row->chars[next] & 0x80)) || !row->render || !row->highLightRuns ||
+        rowIndex >= editorConfig.current->syntaxValidRows) {
+        free(row->columnMap);
+        row->columnMap = NULL;
+        return false;
+    }
+    uint32_t tabStopSize = editorConfig.config->tabStopSize;
+    char * tab = memchr(&row->chars[at], '\t', row->size - at);
+    uint32_t segmentLength = tab ? tab - &row->chars[at] : row->size - at;
+    // The checkpoints up to the next tab move with the modified character, a column map that is created now is
+    // already up to date
+    bool shifted = row->columnMap != NULL;
+    column_map_shift(row->columnMap, at, delta, delta);
+    column_map_position_t segmentEnd = editor_row_find_character(row, at + segmentLength);
+    uint32_t renderX = segmentEnd.render - segmentLength;
+    // Characters after the next tab keep their position relative to the tab stop, where the tab ends
+    uint32_t oldEnd = tab ? segmentEnd.render - delta + tabStopSize - (segmentEnd.column - delta) % tabStopSize
+                          : row->renderSize;
+    uint32_t newEnd = tab ? segmentEnd.render + tabStopSize - segmentEnd.column % tabStopSize : row->renderSize + delta;
+    if (tab && shifted) {
+        column_map_shift(row->columnMap, at + segmentLength, 0, (int32_t)(newEnd - oldEnd) - delta);
+    }
+    uint32_t oldRenderSize = row->renderSize;
+    uint32_t newRenderSize = oldRenderSize + newEnd - oldEnd;
+    uint32_t oldSegmentEnd = renderX + segmentLength - delta;
+    uint32_t newSegmentEnd = renderX + segmentLength;
+    // The window contains the next tab or ends in front of it, so the characters after it are moved by the same amount
+    uint32_t windowStart = renderX > PATCH_HIGHLIGHT_MARGIN ? renderX - PATCH_HIGHLIGHT_MARGIN : 0;
+    bool windowContainsTab = oldEnd - renderX <= PATCH_HIGHLIGHT_MARGIN;
+    uint32_t oldWindowEnd;
+    uint32_t newWindowEnd;
+    if (windowContainsTab) {
+        oldWindowEnd = oldRenderSize - oldEnd > PATCH_HIGHLIGHT_MARGIN ? oldEnd + PATCH_HIGHLIGHT_MARGIN
+                                                                         : oldRenderSize;
+        newWindowEnd = oldWindowEnd + newEnd - oldEnd;
+    } else {
+        oldWindowEnd = oldSegmentEnd - renderX > PATCH_HIGHLIGHT_MARGIN ? renderX + PATCH_HIGHLIGHT_MARGIN
+                                                                          : oldSegmentEnd;
+        newWindowEnd = oldWindowEnd + delta;
+    }
+    uint32_t oldWindowLength = oldWindowEnd - windowStart;
+    uint32_t newWindowLength = newWindowEnd - windowStart;
+    unsigned char tabHighlight = HIGHTLIGHT_NORMAL;
+    if (tab) {
+        highlight_runs_decode_range(row->highLightRuns, row->highLightRunCount, &row->highLightCursor, oldSegmentEnd, 1,
+                                    &tabHighlight);
+    }
+    unsigned char * highLight = editor_reserve_highlight_columns(oldWindowLength > newWindowLength ? oldWindowLength
+                                                                                                  : newWindowLength);
+    highlight_runs_decode_range(row->highLightRuns, row->highLightRunCount, &row->highLightCursor, windowStart,
+                                oldWindowLength, highLight);
+    if (row->renderAliased) {
+        // The row still contains no tabs, the underlying character buffer is already up to date
+        row->render = row->chars;
+    } else {
+        if (newRenderSize > oldRenderSize) {
+            char * render = realloc(row->render, newRenderSize + 1);
+            if (render == NULL) {
+                return false;
+            }
+            row->render = render;
         }
-        cur_rx++;
-        if (cur_rx > renderX) {
-            return cursorCurrentX;
+        memmove(&row->render[newEnd], &row->render[oldEnd], oldRenderSize - oldEnd + 1);
+        memcpy(&row->render[renderX], &row->chars[at], segmentLength);
+        memset(&row->render[renderX + segmentLength], ' ', newEnd - renderX - segmentLength);
+    }
+    // The highlighting is moved with the characters, so the lexer can stop right after the modification
+    if (oldWindowEnd > oldEnd) {
+        memmove(&highLight[newEnd - windowStart], &highLight[oldEnd - windowStart], oldWindowEnd - oldEnd);
+    }
+    uint32_t segmentWindowEnd = oldSegmentEnd < oldWindowEnd ? oldSegmentEnd : oldWindowEnd;
+    if (delta > 0) {
+        memmove(&highLight[renderX + 1 - windowStart], &highLight[renderX - windowStart], segmentWindowEnd - renderX);
+    } else {
+        memmove(&highLight[renderX - windowStart], &highLight[renderX + 1 - windowStart],
+                segmentWindowEnd - renderX - 1);
+    }
+    if (tab && windowContainsTab) {
+        memset(&highLight[newSegmentEnd - windowStart], tabHighlight, newEnd - newSegmentEnd);
+    }
+    row->renderSize = newRenderSize;
+
+    bool insideComment = row->hightLightOpenComment;
+    bool insideWindow = true;
+    uint64_t start = editor_is_profiling() ? editor_now() : 0;
+    if (editorConfig.current->syntax == NULL) {
+        memset(&highLight[renderX - windowStart], HIGHTLIGHT_NORMAL, newWindowEnd - renderX);
+    } else {
+        // Comment delimiters that start before the modification could end after it
+        size_t lookAhead = 0;
+        char * delimiters[] = {editorConfig.current->syntax->singleline_comment_start,
+                               editorConfig.current->syntax->multiline_comment_start,
+                               editorConfig.current->syntax->multiline_comment_end};
+        for (size_t i = 0; i < sizeof(delimiters) / sizeof(delimiters[0]); i++) {
+            size_t length = delimiters[i] ? strlen(delimiters[i]) : 0;
+            if (length > lookAhead + 1) {
+                lookAhead = length - 1;
+            }
+        }
+        uint32_t from = renderX > windowStart + lookAhead ? renderX - lookAhead : windowStart;
+        while (from > windowStart && !(highLight[from - windowStart - 1] == HIGHTLIGHT_NORMAL &&
+                                       lexer_is_separator(&editorConfig.current->lexer,
+                                                          (unsigned char)row->render[from - 1]))) {
+            from--;
+        }
+        // The highlighting in front of the window is unknown, unless the window starts at the beginning of the row
+        insideWindow = from > windowStart || from == 0;
+        if (insideWindow) {
+            uint32_t stop;
+            insideComment = from == 0 && rowIndex > 0 && editor_get_row(rowIndex - 1)->hightLightOpenComment;
+            insideComment = lexer_highlight(&editorConfig.current->lexer, &row->render[windowStart], newWindowLength,
+                                            highLight, from - windowStart, insideComment,
+                                            renderX + (delta > 0 ? 1 : 0) - windowStart, row->hightLightOpenComment,
+                                            &stop);
+            // Delimiters that are cut off at the end of the window could have been missed by the lexer
+            insideWindow = newWindowEnd == newRenderSize || stop + lookAhead < newWindowLength;
+        }
+    }
+    if (!insideWindow) {
+        // The highlighting changes beyond the window, so the whole row is highlighted again
+        insideComment = editor_highlight_row(row, rowIndex > 0 && editor_get_row(rowIndex - 1)->hightLightOpenComment);
+    } else {
+        if (!highlight_runs_splice(&row->highLightRuns, &row->highLightRunCount, &row->highLightCursor, windowStart,
+                                   oldWindowLength, highLight, newWindowLength)) {
+            return false;
+        }
+        if (tab && !windowContainsTab && (int32_t)(newEnd - oldEnd) != delta) {
+            // The window ends in front of the tab, that absorbed or released a column
+            highLight = editor_reserve_highlight_columns(newEnd - newSegmentEnd);
+            memset(highLight, tabHighlight, newEnd - newSegmentEnd);
+            if (!highlight_runs_splice(&row->highLightRuns, &row->highLightRunCount, &row->highLightCursor,
+                                       newSegmentEnd, oldEnd - oldSegmentEnd, highLight, newEnd - newSegmentEnd)) {
+                return false;
+            }
         }
+        if (start) {
+            editor_record_highlight(start);
+        }
+    }
+    if (insideComment != row->hightLightOpenComment) {
+        row->hightLightOpenComment = insideComment;
+        editor_propagate_syntax(rowIndex + 1);
     }
-    return cursorCurrentX;
+    return true;
 }
 
-/// @brief Coverts the rows of the editor to a character sequence and returns a
-/// pointer to the begining of that sequence
-/// @param bufferLength Pointer to the length of the underlying buffer
-/// @return The created character sequence
-static char * editor_rows_to_string(uint32_t * bufferLength) {
-    size_t totlen = 0;
-    size_t j;
-    for (j = 0; j < editorConfig.numberOfRows; j++) {
-        totlen += editorConfig.editorRows[j].size + 1;
-    }
-    *bufferLength = totlen;
-    char * buffer = malloc(totlen);
-    char * bufferPointer = buffer;
-    for (j = 0; j < editorConfig.numberOfRows; j++) {
-        memcpy(bufferPointer, editorConfig.editorRows[j].chars, editorConfig.editorRows[j].size);
-        bufferPointer += editorConfig.editorRows[j].size;
-        *bufferPointer = '\n';
-        bufferPointer++;
+/// @brief Determines the position of the character that is displayed at a
+/// column
+/// @param row The row where the character is located
+/// @param column The column
+/// @return The position of the character or the end of the row
+static column_map_position_t editor_row_find_column(editor_row_t * row, uint32_t column) {
+    return column_map_find_column(editor_row_column_map(row), row->chars, row->size,
+                                  editorConfig.config->tabStopSize, column);
+}
+
+/// @brief Determines the position of a character in the render buffer and on
+/// the screen
+/// @param row The row where the character is located
+/// @param at The index of the character in the underlying character buffer
+/// @return The position of the character
+static column_map_position_t editor_row_find_character(editor_row_t * row, uint32_t at) {
+    return column_map_find_character(editor_row_column_map(row), row->chars, row->size,
+                                     editorConfig.config->tabStopSize, at);
+}
+
+/// @brief Processes chunks of work with a worker thread per chunk
+/// @param function The function that processes a single chunk
+/// @param chunks The chunks, at most PARALLEL_MAXIMUM_THREADS
+/// @param chunkSize The size of a single chunk in bytes
+/// @param chunkCount The amount of chunks
+/// @details The first chunk is processed by the calling thread, as well as
+/// every chunk that no thread could be created for
+static void editor_run_parallel(void * (*function)(void *), void * chunks, size_t chunkSize, uint32_t chunkCount) {
+    pthread_t threads[PARALLEL_MAXIMUM_THREADS];
+    bool threadStarted[PARALLEL_MAXIMUM_THREADS];
+    for (uint32_t t = 1; t < chunkCount; t++) {
+        void * chunk = (char *)chunks + chunkSize * t;
+        threadStarted[t] = !pthread_create(&threads[t], NULL, function, chunk);
+        if (!threadStarted[t]) {
+            function(chunk);
+        }
+    }
+    function(chunks);
+    for (uint32_t t = 1; t < chunkCount; t++) {
+        if (threadStarted[t]) {
+            pthread_join(threads[t], NULL);
+        }
     }
-    return buffer;
 }
 
 /// @brief Saves the file that is currently opened
+/// @details The rows are written by a background thread, the result is shown
+/// once the thread is done. Rows modified in the meantime are copied first.
+/// Large ranges of unmodified rows are copied from the opened file directly
 static void editor_save() {
-    if (editorConfig.fileName == NULL) {
-        editorConfig.fileName = editor_prompt("Save as: %s (ESC to cancel)", NULL);
-        if (editorConfig.fileName == NULL) {
+    if (editorConfig.current->fileName == NULL) {
+        editorConfig.current->fileName = editor_prompt("Save as: %s (ESC to cancel)", NULL, false);
+        if (editorConfig.current->fileName == NULL) {
             editor_set_status_message("Save aborted");
             return;
         }
         editor_select_syntax_highlight();
     }
-    uint32_t length;
-    char * buffer = editor_rows_to_string(&length);
-    int fileDescriptor = open(editorConfig.fileName, O_RDWR | O_CREAT, 0644);
-    if (fileDescriptor != -1) {
-        if (ftruncate(fileDescriptor, length) != -1) {
-            if (write(fileDescriptor, buffer, length) == length) {
-                close(fileDescriptor);
-                free(buffer);
-                editorConfig.unsavedChanges = false;
-                editor_set_status_message("%d bytes written to disk", length);
-                return;
+    editor_finish_save(true);
+    struct iovec * lines = malloc(sizeof(struct iovec) * (editorConfig.current->numberOfRows + 1));
+    if (lines == NULL) {
+        editor_set_status_message("Can't save! I/O error: %s", strerror(ENOMEM));
+        return;
+    }
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_row_t * row = editor_get_row(at);
+        lines[at].iov_base = row->chars;
+        lines[at].iov_len = row->size;
+    }
+    uint32_t copyCount;
+    save_job_copy_t * copies = editor_find_unmodified_ranges(&copyCount);
+    // Symbolic links are kept, the file they point to is replaced
+    char * path = realpath(editorConfig.current->fileName, NULL);
+    bool started = save_job_start(&editorConfig.current->saveJob, path ? path : editorConfig.current->fileName, lines,
+                                  editorConfig.current->numberOfRows, editorConfig.current->mappingFileDescriptor,
+                                  copies, copyCount);
+    free(path);
+    if (!started) {
+        editor_set_status_message("Can't save! I/O error: %s", strerror(editorConfig.current->saveJob.error));
+        save_job_reset(&editorConfig.current->saveJob);
+        return;
+    }
+    // Rows from the memory mapped file stay valid, because the file is replaced and not overwritten
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_row_t * row = editor_get_row(at);
+        row->shared = !row->mapped;
+    }
+    editorConfig.current->unsavedChanges = false;
+    editor_set_status_message("Saving...");
+    event_loop_start_timer(&editorConfig.eventLoop, editorConfig.saveTimer, SAVE_POLL_INTERVAL);
+}
+
+/// @brief Determines the multiline comment state of all rows before the
+/// specified row
+/// @param until The index of the first row, that's state is not needed
+/// @details Rows that were not rendered yet are only rendered temporarily
+static void editor_scan_syntax(uint32_t until) {
+    bool hasMultiLineComments = editor_has_multiline_comments();
+    while (editorConfig.current->syntaxValidRows < until) {
+        uint32_t at = editorConfig.current->syntaxValidRows;
+        editor_row_t * row = editor_get_row(at);
+        if (row->render) {
+            editor_update_syntax(at);
+        } else if (!hasMultiLineComments) {
+            row->hightLightOpenComment = false;
+            editorConfig.current->syntaxValidRows++;
+            if (editorConfig.current->syntaxConsistentRows < editorConfig.current->syntaxValidRows) {
+                editorConfig.current->syntaxConsistentRows = editorConfig.current->syntaxValidRows;
             }
+        } else {
+            editor_update_row(at);
+            editor_release_row(row);
         }
-        close(fileDescriptor);
     }
-    free(buffer);
-    editor_set_status_message("Can't save! I/O error: %s", strerror(errno));
+}
+
+/// @brief Determines the multiline comment state at the end of each row of a
+/// chunk, for both possible states at the start of the chunk
+/// @param argument The syntax_scan_chunk_t that is scanned
+/// @return NULL
+/// @details The rows are rendered and highlighted in a buffer owned by the
+/// thread, the rows themselves are not modified. A row can swap both states,
+/// so whether they agree is determined at the start of every row. Once they
+/// are equal at the start of a row, they stay equal for the rest of the chunk
+/// and only one of them is determined
+static void * editor_scan_syntax_chunk(void * argument) {
+    syntax_scan_chunk_t * chunk = argument;
+    editor_row_t scratch = {0};
+    unsigned char * highLight = NULL;
+    uint32_t highLightCapacity = 0;
+    bool insideComment[2] = {false, true};
+    for (uint32_t at = chunk->begin; at < chunk->end; at++) {
+        editor_row_t * row = editor_get_row(at);
+        scratch.chars = row->chars;
+        scratch.size = row->size;
+        editor_render_row(&scratch);
+        if (scratch.renderSize > highLightCapacity) {
+            free(highLight);
+            highLightCapacity = scratch.renderSize;
+            highLight = malloc(highLightCapacity);
+            if (highLight == NULL) {
+                editor_die("malloc");
+            }
+        }
+        // The agreement is determined before the row, a row can swap both states
+        bool agreed = insideComment[0] == insideComment[1];
+        insideComment[0] = editor_highlight_columns(&scratch, highLight, insideComment[0]);
+        insideComment[1] = agreed ? insideComment[0] : editor_highlight_columns(&scratch, highLight, insideComment[1]);
+        chunk->states[at - chunk->begin] = (uint8_t)(insideComment[0] | insideComment[1] << 1);
+    }
+    if (!scratch.renderAliased) {
+        free(scratch.render);
+    }
+    free(highLight);
+    return NULL;
+}
+
+/// @brief Determines the multiline comment state of all rows below the rows
+/// that are already up to date, using a worker thread per processor
+/// @details Each thread scans a chunk of rows speculatively for both states at
+/// the start of the chunk. Afterwards the chunks are stitched together in
+/// order, using the state at the end of the previous chunk
+static void editor_scan_syntax_parallel() {
+    uint32_t begin = editorConfig.current->syntaxValidRows;
+    if (!editor_has_multiline_comments() || begin >= editorConfig.current->numberOfRows) {
+        return;
+    }
+    uint32_t rowCount = editorConfig.current->numberOfRows - begin;
+    long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threadCount = rowCount / PARALLEL_SCAN_MINIMUM_CHUNK_SIZE;
+    if (processorCount > 0 && threadCount > (uint32_t)processorCount) {
+        threadCount = processorCount;
+    }
+    if (threadCount > PARALLEL_SCAN_MAXIMUM_THREADS) {
+        threadCount = PARALLEL_SCAN_MAXIMUM_THREADS;
+    }
+    if (threadCount < 2) {
+        // Small files are scanned lazily
+        return;
+    }
+    uint8_t * states = malloc(rowCount);
+    if (states == NULL) {
+        return;
+    }
+    syntax_scan_chunk_t chunks[PARALLEL_SCAN_MAXIMUM_THREADS];
+    pthread_t threads[PARALLEL_SCAN_MAXIMUM_THREADS];
+    bool threadStarted[PARALLEL_SCAN_MAXIMUM_THREADS];
+    for (uint32_t t = 0; t < threadCount; t++) {
+        chunks[t].begin = begin + (uint32_t)((uint64_t)rowCount * t / threadCount);
+        chunks[t].end = begin + (uint32_t)((uint64_t)rowCount * (t + 1) / threadCount);
+        chunks[t].states = &states[chunks[t].begin - begin];
+        threadStarted[t] = !pthread_create(&threads[t], NULL, editor_scan_syntax_chunk, &chunks[t]);
+        if (!threadStarted[t]) {
+            // The chunk is scanned by the main thread, if no thread could be created
+            editor_scan_syntax_chunk(&chunks[t]);
+        }
+    }
+    bool insideComment = begin > 0 && editor_get_row(begin - 1)->hightLightOpenComment;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        if (threadStarted[t]) {
+            pthread_join(threads[t], NULL);
+        }
+        uint8_t startState = insideComment;
+        for (uint32_t at = chunks[t].begin; at < chunks[t].end; at++) {
+            editor_row_t * row = editor_get_row(at);
+            if (row->render) {
+                // Rendered rows may have been highlighted with an outdated state
+                editor_highlight_row(row, insideComment);
+            }
+            insideComment = (states[at - begin] >> startState) & 1;
+            row->hightLightOpenComment = insideComment;
+        }
+    }
+    free(states);
+    editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows =
+        editorConfig.current->numberOfRows;
 }
 
 /// @brief Scrolls throught the opened file
 static void editor_scroll() {
-    editorConfig.renderX = 0;
-    if (editorConfig.cursorCurrentY < editorConfig.numberOfRows) {
-        editorConfig.renderX =
-            editor_row_cx_to_rx(&editorConfig.editorRows[editorConfig.cursorCurrentY], editorConfig.cursorCurrentX);
+    editorConfig.current->renderX = 0;
+    // The amount of columns of the character under the cursor, that have to be visible
+    uint32_t width = 1;
+    if (editorConfig.current->cursorCurrentY < editorConfig.current->numberOfRows) {
+        editor_row_t * row = editor_get_row(editorConfig.current->cursorCurrentY);
+        editorConfig.current->renderX = editor_row_find_character(row, editorConfig.current->cursorCurrentX).column;
+        if (editorConfig.current->cursorCurrentX < row->size &&
+            row->chars[editorConfig.current->cursorCurrentX] != '\t') {
+            uint32_t length;
+            width = column_map_width(row->chars, row->size, editorConfig.current->cursorCurrentX, &length);
+            width = width ? width : 1;
+        }
+    }
+    if (editorConfig.current->cursorCurrentY < editorConfig.current->rowOffset) {
+        editorConfig.current->rowOffset = editorConfig.current->cursorCurrentY;
     }
-    if (editorConfig.cursorCurrentY < editorConfig.rowOffset) {
-        editorConfig.rowOffset = editorConfig.cursorCurrentY;
+    if (editorConfig.current->cursorCurrentY >= editorConfig.current->rowOffset + editorConfig.screenRows) {
+        editorConfig.current->rowOffset = editorConfig.current->cursorCurrentY - editorConfig.screenRows + 1;
     }
-    if (editorConfig.cursorCurrentY >= editorConfig.rowOffset + editorConfig.screenRows) {
-        editorConfig.rowOffset = editorConfig.cursorCurrentY - editorConfig.screenRows + 1;
+    if (editorConfig.current->renderX < editorConfig.current->columnOffset) {
+        editorConfig.current->columnOffset = editorConfig.current->renderX;
     }
-    if (editorConfig.renderX < editorConfig.columnOffset) {
-        editorConfig.columnOffset = editorConfig.renderX;
+    if (editorConfig.current->renderX + width > editorConfig.current->columnOffset + editorConfig.screenColumns) {
+        editorConfig.current->columnOffset = editorConfig.current->renderX + width - editorConfig.screenColumns;
     }
-    if (editorConfig.renderX >= editorConfig.columnOffset + editorConfig.screenColumns) {
-        editorConfig.columnOffset = editorConfig.renderX - editorConfig.screenColumns + 1;
+}
+
+/// @brief Selects the register that is used by the next yank or paste
+/// @details The register is named by the next key, a to z. Any other key
+/// selects the unnamed register
+static void editor_select_register() {
+    editor_set_status_message("Register (a-z):");
+    editor_refresh_screen();
+    uint32_t c = editor_read_key();
+    if (c >= 'a' && c <= 'z') {
+        editorConfig.selectedRegister = c - 'a' + 1;
+        editor_set_status_message("Register %c selected", (char)c);
+    } else {
+        editorConfig.selectedRegister = 0;
+        editor_set_status_message("Unnamed register selected");
     }
 }
 
 /// @brief Changes the currently selected syntax highlighting configuration
 static void editor_select_syntax_highlight() {
-    editorConfig.syntax = NULL;
-    if (editorConfig.fileName == NULL) {
+    editorConfig.current->syntax = NULL;
+    lexer_compile(&editorConfig.current->lexer, NULL);
+    if (editorConfig.current->fileName == NULL) {
         return;
     }
-    char * fileExtension = strrchr(editorConfig.fileName, '.');
+    char * fileExtension = strrchr(editorConfig.current->fileName, '.');
     size_t languageCount = syntax_get_language_count();
     for (size_t j = 0; j < languageCount; j++) {
         editor_syntax_t * s = &HighLightDataBase[j];
@@ -1252,11 +3950,11 @@ static void editor_select_syntax_highlight() {
         while (s->filematch[i]) {
             bool isFileExtension = (s->filematch[i][0] == '.');
             if ((isFileExtension && fileExtension && !strcmp(fileExtension, s->filematch[i])) ||
-                (!isFileExtension && strstr(editorConfig.fileName, s->filematch[i]))) {
-                editorConfig.syntax = s;
-                for (uint32_t filerow = 0; filerow < editorConfig.numberOfRows; filerow++) {
-                    editor_update_syntax(&editorConfig.editorRows[filerow]);
-                }
+                (!isFileExtension && strstr(editorConfig.current->fileName, s->filematch[i]))) {
+                editorConfig.current->syntax = s;
+                lexer_compile(&editorConfig.current->lexer, s);
+                // Rows are highlighted again once they are needed
+                editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows = 0;
                 return;
             }
             i++;
@@ -1272,176 +3970,180 @@ static void editor_set_status_message(char const * format, ...) {
     va_start(argumentPointer, format);
     vsnprintf(editorConfig.statusMessage, sizeof(editorConfig.statusMessage), format, argumentPointer);
     va_end(argumentPointer);
-    editorConfig.statusMessageTimeStamp = time(NULL);
+    editorConfig.statusMessageTimeStamp = event_loop_now();
+    event_loop_start_timer(&editorConfig.eventLoop, editorConfig.statusMessageTimer,
+                           (uint32_t)editorConfig.config->messageDisplayDuration * 1000);
 }
 
 /// Shows the hotkeys of the editor as a status message
 static inline void editor_show_help() {
-    editor_set_status_message("HELP: Ctrl-D = delete | Ctrl-F = find | Ctrl-H = help | Ctrl-O = open | "
-                              "Ctrl-P = paste | Ctrl-Q = quit | Ctrl-S = save| Ctrl-X execute | Ctrl-Y "
-                              "= yank");
+    editor_set_status_message("HELP: Ctrl-D=delete | Ctrl-F=find | Ctrl-G=replace | Ctrl-H=help | Ctrl-K=mark | "
+                              "Ctrl-N=next file | Ctrl-O=open | Ctrl-P=paste | Ctrl-Q=quit | Ctrl-R=register | "
+                              "Ctrl-S=save | Ctrl-T=timings | Ctrl-W=close | Ctrl-X=execute | Ctrl-Y=yank");
 }
 
-/// @brief Updates the contents that are diplayed by a single editor row
-/// @param row The row that is updated
-static void editor_update_row(editor_row_t * row) {
-    size_t tabs = 0;
-    size_t j;
-    for (j = 0; j < row->size; j++) {
-        if (row->chars[j] == '\t') {
-            tabs++;
-        }
+/// @brief Creates the rows of the lines that start in a range of the memory
+/// mapped file, after they were counted
+/// @param argument The line_split_chunk_t whose lines are split into rows
+/// @return NULL
+/// @details The last line of the range may end in one of the following ranges.
+/// Carriage returns at the end of the lines are stripped
+static void * editor_split_lines_chunk(void * argument) {
+    line_split_chunk_t * chunk = argument;
+    char * fileEnd = chunk->mapping + chunk->fileSize;
+    char * chunkEnd = chunk->mapping + chunk->end;
+    char * lineStart = chunk->mapping;
+    if (chunk->begin) {
+        lineStart = memchr(&chunk->mapping[chunk->begin - 1], '\n', chunk->end - chunk->begin);
+        lineStart = lineStart ? lineStart + 1 : chunkEnd;
     }
-    free(row->render);
-    row->render = malloc(row->size + tabs * (editorConfig.config->tabStopSize - 1) + 1);
-    size_t idx = 0;
-    for (j = 0; j < row->size; j++) {
-        if (row->chars[j] == '\t') {
-            row->render[idx++] = ' ';
-            while (idx % editorConfig.config->tabStopSize != 0) {
-                row->render[idx++] = ' ';
-            }
-        } else {
-            row->render[idx++] = row->chars[j];
+    editor_row_t * row = chunk->rows;
+    while (lineStart < chunkEnd) {
+        char * lineEnd = memchr(lineStart, '\n', fileEnd - lineStart);
+        char * nextLine = lineEnd ? lineEnd + 1 : fileEnd;
+        if (!lineEnd) {
+            lineEnd = fileEnd;
         }
+        while (lineEnd > lineStart && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+        editor_init_row(row++, lineStart, lineEnd - lineStart, true);
+        lineStart = nextLine;
     }
-    row->render[idx] = '\0';
-    row->renderSize = idx;
-
-    editor_update_syntax(row);
+    return NULL;
 }
 
-/// @brief Updates the syntax highlighting for a given editor row
-/// @param row The editor row where the syntax highlighting is applied
-static void editor_update_syntax(editor_row_t * row) {
-    row->highLight = realloc(row->highLight, row->renderSize);
-    memset(row->highLight, HIGHTLIGHT_NORMAL, row->renderSize);
-
-    if (editorConfig.syntax == NULL) {
+/// @brief Displays another opened file
+/// @param buffer The buffer of the file that is displayed
+/// @details The rows, the highlighting and the cursor of the previous file
+/// stay resident, so switching back does not load the file again
+static void editor_switch_buffer(editor_buffer_t * buffer) {
+    if (buffer == editorConfig.current) {
         return;
     }
+    // A save in progress is completed in the background, the save timer polls the saves of all files
+    editorConfig.current = buffer;
+    editorConfig.quitTimes = QUIT_TIMES;
+    editor_set_status_message("%s (%u/%u)", buffer->fileName ? buffer->fileName : "[No file name]",
+                              editor_buffer_index(buffer) + 1, editorConfig.bufferCount);
+}
 
-    char ** keywords = editorConfig.syntax->keywords;
-    char * singleLineCommentStart = editorConfig.syntax->singleline_comment_start;
-    char * multiLineCommentStart = editorConfig.syntax->multiline_comment_start;
-    char * multiLineCommentEnd = editorConfig.syntax->multiline_comment_end;
-    size_t singleLineCommentStartLength = singleLineCommentStart ? strlen(singleLineCommentStart) : 0;
-    size_t multiLineCommentStartLength = multiLineCommentStart ? strlen(multiLineCommentStart) : 0;
-    size_t multiLineCommentEndLength = multiLineCommentEnd ? strlen(multiLineCommentEnd) : 0;
-    bool previousSeperator = true;
-    int insideString = 0;
-    bool insideComment = (row->index > 0 && editorConfig.editorRows[row->index - 1].hightLightOpenComment);
-    size_t i = 0;
-    while (i < row->renderSize) {
-        char c = row->render[i];
-        unsigned char prevoiusHighlighting = (i > 0) ? row->highLight[i - 1] : HIGHTLIGHT_NORMAL;
+/// @brief Shows or hides the measurements of the last frame in the status bar
+static inline void editor_toggle_hud() {
+    editorConfig.hudVisible = !editorConfig.hudVisible;
+}
 
-        if (singleLineCommentStartLength && !insideString && !insideComment) {
-            if (!strncmp(&row->render[i], singleLineCommentStart, singleLineCommentStartLength)) {
-                memset(&row->highLight[i], HIGHLIGHT_COMMENT, row->renderSize - i);
-                break;
-            }
-        }
-        if (multiLineCommentStartLength && multiLineCommentEndLength && !insideString) {
-            if (insideComment) {
-                row->highLight[i] = HIGHLIGHT_MLCOMMENT;
-                if (!strncmp(&row->render[i], multiLineCommentEnd, multiLineCommentEndLength)) {
-                    memset(&row->highLight[i], HIGHLIGHT_MLCOMMENT, multiLineCommentEndLength);
-                    i += multiLineCommentEndLength;
-                    insideComment = 0;
-                    previousSeperator = true;
-                    continue;
-                } else {
-                    i++;
-                    continue;
-                }
-            } else if (!strncmp(&row->render[i], multiLineCommentStart, multiLineCommentStartLength)) {
-                memset(&row->highLight[i], HIGHLIGHT_MLCOMMENT, multiLineCommentStartLength);
-                i += multiLineCommentStartLength;
-                insideComment = 1;
-                continue;
-            }
-        }
-        if (editorConfig.syntax->flags & SYNTAX_HIGHLIGHT_STRINGS) {
-            if (insideString) {
-                row->highLight[i] = HIGHLIGHT_STRING;
-                if (c == '\\' && i + 1 < row->renderSize) {
-                    row->highLight[i + 1] = HIGHLIGHT_STRING;
-                    i += 2;
-                    continue;
-                }
-                if (c == insideString) {
-                    insideString = 0;
-                }
-                i++;
-                previousSeperator = true;
-                continue;
-            } else {
-                if (c == '"' || c == '\'') {
-                    insideString = c;
-                    row->highLight[i] = HIGHLIGHT_STRING;
-                    i++;
-                    continue;
-                }
-            }
-        }
+/// @brief Writes an event to the trace
+/// @param format The format of the event
+/// @param  args The arguments that are used to create the event
+/// @details Every event is preceded by the milliseconds since the trace was
+/// started
+static void editor_trace(char const * format, ...) {
+    fprintf(editorConfig.traceFile, "%.3f ", (editor_now() - editorConfig.traceStart) / 1e6);
+    va_list argumentPointer;
+    va_start(argumentPointer, format);
+    vfprintf(editorConfig.traceFile, format, argumentPointer);
+    va_end(argumentPointer);
+    fputc('\n', editorConfig.traceFile);
+}
 
-        if (editorConfig.syntax->flags & SYNTAX_HIGHLIGHT_NUMBERS) {
-            if ((isdigit(c) && (previousSeperator || prevoiusHighlighting == HIGHLIGHT_NUMBER)) ||
-                (c == '.' && prevoiusHighlighting == HIGHLIGHT_NUMBER)) {
-                row->highLight[i] = HIGHLIGHT_NUMBER;
-                i++;
-                previousSeperator = false;
-                continue;
-            }
-        }
-        if (previousSeperator) {
-            uint32_t j;
-            for (j = 0; keywords[j]; j++) {
-                size_t keywordLength = strlen(keywords[j]);
-                bool belongsToSecondKeywordGroup = keywords[j][keywordLength - 1] == '|';
-                bool belongsToThirdKeywordGroup = keywords[j][keywordLength - 1] == '&';
-                bool belongsToFourthKeywordGroup = keywords[j][keywordLength - 1] == '~';
-                if (belongsToSecondKeywordGroup || belongsToThirdKeywordGroup || belongsToFourthKeywordGroup) {
-                    keywordLength--;
-                }
-                if (!strncmp(&row->render[i], keywords[j], keywordLength) &&
-                    editor_is_separator(row->render[i + keywordLength])) {
-                    // We select the color of our syntax highlighting based on the keyword
-                    // group
-                    if (belongsToSecondKeywordGroup) {
-                        memset(&row->highLight[i], HIGHLIGHT_KEYWORDS_SECOND_GROUP, keywordLength);
-                    } else if (belongsToThirdKeywordGroup) {
-                        memset(&row->highLight[i], HIGHLIGHT_KEYWORDS_THIRD_GROUP, keywordLength);
-                    } else if (belongsToFourthKeywordGroup) {
-                        memset(&row->highLight[i], HIGHLIGHT_KEYWORDS_FOURTH_GROUP, keywordLength);
-                    } else {
-                        memset(&row->highLight[i], HIGHLIGHT_KEYWORDS_FIRST_GROUP, keywordLength);
-                    }
-                    i += keywordLength;
-                    break;
-                }
-            }
-            if (keywords[j]) {
-                previousSeperator = false;
-                continue;
-            }
-        }
-        previousSeperator = editor_is_separator(c);
-        i++;
+/// @brief Copies the rows that still point into the memory mapped file to the
+/// heap, unmaps the file and closes it
+static void editor_unmap_file() {
+    if (editorConfig.current->mapping == NULL) {
+        return;
     }
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_row_detach(editor_get_row(at));
+    }
+    munmap(editorConfig.current->mapping, editorConfig.current->mappingLength);
+    close(editorConfig.current->mappingFileDescriptor);
+    editorConfig.current->mapping = NULL;
+    editorConfig.current->mappingLength = 0;
+    editorConfig.current->mappingFileDescriptor = -1;
+}
+
+/// @brief Updates the contents that are diplayed by a single editor row
+/// @param at The index of the row that is updated
+static void editor_update_row(uint32_t at) {
+    editor_render_row(editor_get_row(at));
+    editor_update_syntax(at);
+}
+
+/// @brief Updates the syntax highlighting for a given editor row
+/// @param at The index of the editor row where the syntax highlighting is applied
+static void editor_update_syntax(uint32_t at) {
+    // The multiline comment state of the previous row needs to be known
+    editor_scan_syntax(at);
+    editor_row_t * row = editor_get_row(at);
+    bool insideComment = editor_highlight_row(row, at > 0 && editor_get_row(at - 1)->hightLightOpenComment);
     bool changed = (row->hightLightOpenComment != insideComment);
     row->hightLightOpenComment = insideComment;
-    if (changed && row->index + 1 < editorConfig.numberOfRows) {
-        editor_update_syntax(&editorConfig.editorRows[row->index + 1]);
+    if (at >= editorConfig.current->syntaxValidRows) {
+        // The following consistent rows are up to date again, if the state did not change
+        editorConfig.current->syntaxValidRows = (!changed && at + 1 < editorConfig.current->syntaxConsistentRows)
+                                                    ? editorConfig.current->syntaxConsistentRows
+                                                    : at + 1;
+        if (editorConfig.current->syntaxConsistentRows < editorConfig.current->syntaxValidRows) {
+            editorConfig.current->syntaxConsistentRows = editorConfig.current->syntaxValidRows;
+        }
+    } else if (changed) {
+        editor_propagate_syntax(at + 1);
+    }
+}
+
+/// @brief Waits for input from the terminal, while the timers and signals of
+/// the editor are handled
+/// @param timeout The maximum amount of milliseconds to wait, -1 waits
+/// indefinitely
+/// @return true if input is available, false if not
+/// @details The screen is redrawn if a timer or signal requires it and no
+/// input is available
+static bool editor_wait_for_input(int32_t timeout) {
+    bool readable = event_loop_wait(&editorConfig.eventLoop, editorConfig.inputFileDescriptor, timeout);
+    if (!readable && editorConfig.redrawPending) {
+        editor_refresh_screen();
     }
+    return readable;
 }
 
-/// @brief Yanks the line the cursor is currently positioned in
-/// @details For that purpose the content of the line is stored in the
-/// copy-buffer of the editor The content of the copy buffer can be pasted
-/// afterwords
-static inline void editor_yank_line() {
-    copy_buffer_write(&editorConfig.copyBuffer, (char *)editorConfig.editorRows[editorConfig.cursorCurrentY].chars,
-                      editorConfig.editorRows[editorConfig.cursorCurrentY].size);
+/// @brief Yanks the line the cursor is currently positioned in or the marked
+/// lines
+/// @param begin Is set to the index of the first yanked row - NULL if not
+/// needed
+/// @param end Is set to the index of the row after the last yanked row - NULL
+/// if not needed
+/// @return true if the lines were yanked, false if not
+/// @details For that purpose the content of the lines is stored in the selected
+/// register of the editor as a single block. The content of the register can be
+/// pasted afterwords
+static bool editor_yank_lines(uint32_t * begin, uint32_t * end) {
+    copy_buffer_t * copyBuffer = &editorConfig.registers[editorConfig.selectedRegister];
+    editorConfig.selectedRegister = 0;
+    uint32_t first, last;
+    if (!editor_marked_rows(&first, &last)) {
+        return false;
+    }
+    size_t length = 0;
+    for (uint32_t at = first; at < last; at++) {
+        length += editor_get_row(at)->size;
+    }
+    if (!copy_buffer_reset(copyBuffer, length, last - first)) {
+        editor_set_status_message("Not enough memory to yank %u lines", last - first);
+        return false;
+    }
+    for (uint32_t at = first; at < last; at++) {
+        editor_row_t const * row = editor_get_row(at);
+        copy_buffer_append_line(copyBuffer, row->chars, row->size);
+    }
+    if (last - first > 1) {
+        editor_set_status_message("%u lines yanked", last - first);
+    }
+    if (begin) {
+        *begin = first;
+    }
+    if (end) {
+        *end = last;
+    }
+    return true;
 }
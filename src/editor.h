@@ -21,17 +21,55 @@
 #ifndef YATE_EDITOR_H_
 #define YATE_EDITOR_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "config_reader.h"
 
+/// Called after a frame was drawn, with the amount of bytes that were written
+/// to the terminal for it
+typedef void (*editor_frame_callback_t)(size_t);
+
 /// @brief Enables raw mode for the current terminal session instead of
 /// canonical mode
 void editor_enable_raw_mode();
 
+/// @brief Opens a file and adds the lines, that are appended to the file
+/// afterwards, to the rows as well
+/// @param filePath The path of the file that is followed, it must be a regular
+/// file
+/// @param maximumRows The maximum amount of rows that are kept, the oldest rows
+/// are dropped first - 0 if all rows are kept
+/// @details The file is checked for new lines periodically without being
+/// opened again. A file that was truncated is read from its start again
+void editor_follow(char const * filePath, uint32_t maximumRows);
+
+/// @brief Determines whether there is input from the terminal, that was not
+/// processed yet
+/// @return true if there is pending input, false if not
+bool editor_has_pending_input();
+
 /// @brief Initializes the editor
 void editor_initialize(configuration_reader_result_t * config);
 
+/// @brief Initializes the editor with a terminal of a fixed size, that is not
+/// necessarily the terminal of the process
+/// @param config The configuration of the editor
+/// @param inputFileDescriptor File descriptor the input is read from, it should
+/// not block once all input was read
+/// @param outputFileDescriptor File descriptor the frames are written to
+/// @param rows The amount of rows of the terminal
+/// @param columns The amount of columns of the terminal
+/// @details Used to drive the editor without a real terminal, for example by
+/// the benchmarks. The terminal is not resized
+void editor_initialize_with_terminal(configuration_reader_result_t * config, int inputFileDescriptor,
+                                     int outputFileDescriptor, uint32_t rows, uint32_t columns);
+
 /// @brief Opens a file and renders the content of the file
 /// @param filePath The path of the file that is opened, read and rendered
+/// @details Every file is opened in a buffer of its own, files that were
+/// opened already are displayed again without being read another time
 void editor_open(char const * filePath);
 
 /// @brief Processes a single keypress
@@ -40,4 +78,19 @@ void editor_process_keypress();
 /// @brief Refreshes the content that is rendered by the editor
 void editor_refresh_screen();
 
+/// @brief Sets the function that is called after every frame
+/// @param callback The function that is called, NULL if none should be called
+void editor_set_frame_callback(editor_frame_callback_t callback);
+
+/// @brief Starts writing the measurements of every keypress and frame to a
+/// trace
+/// @param path The path of the trace file, that is created
+/// @return true if the trace was started, false if the file could not be
+/// created
+bool editor_start_trace(char const * path);
+
+/// @brief Waits until the saves in the background of all opened files are
+/// completed
+void editor_wait_for_save();
+
 #endif
\ No newline at end of file
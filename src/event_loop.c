@@ -0,0 +1,248 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file event_loop.c
+ * @brief File containing the implementation of the event loop.
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+#define _GNU_SOURCE
+
+#include "event_loop.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// The end of the pipe, where the signal handler writes the received signals to
+static int signalPipeInput = -1;
+
+static void event_loop_dispatch_signals(event_loop_t *);
+static void event_loop_dispatch_timers(event_loop_t *);
+static void event_loop_dispatch_watches(event_loop_t *, struct pollfd const *, uint32_t);
+static void event_loop_forward_signal(int);
+static int event_loop_poll_timeout(event_loop_t *, int32_t);
+
+int32_t event_loop_add_timer(event_loop_t * loop, event_loop_callback_t callback) {
+    if (loop->timerCount == EVENT_LOOP_MAXIMUM_TIMERS) {
+        return -1;
+    }
+    loop->timers[loop->timerCount].deadline = 0;
+    loop->timers[loop->timerCount].callback = callback;
+    return (int32_t)loop->timerCount++;
+}
+
+void event_loop_free(event_loop_t * loop) {
+    for (uint32_t i = 0; i < loop->signalCount; i++) {
+        signal(loop->signals[i], SIG_DFL);
+    }
+    if (loop->signalPipe[0] != -1) {
+        close(loop->signalPipe[0]);
+        close(loop->signalPipe[1]);
+    }
+    if (signalPipeInput == loop->signalPipe[1]) {
+        signalPipeInput = -1;
+    }
+    loop->signalPipe[0] = loop->signalPipe[1] = -1;
+    loop->signalCount = loop->timerCount = loop->watchCount = 0;
+}
+
+bool event_loop_handle_signal(event_loop_t * loop, int signal, event_loop_callback_t callback) {
+    if (loop->signalCount == EVENT_LOOP_MAXIMUM_SIGNALS) {
+        return false;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = event_loop_forward_signal;
+    // Interrupted system calls are restarted, only poll returns early
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signal, &action, NULL) == -1) {
+        return false;
+    }
+    signalPipeInput = loop->signalPipe[1];
+    loop->signals[loop->signalCount] = signal;
+    loop->signalCallbacks[loop->signalCount++] = callback;
+    return true;
+}
+
+bool event_loop_init(event_loop_t * loop) {
+    loop->signalCount = loop->timerCount = loop->watchCount = 0;
+    if (pipe(loop->signalPipe) == -1) {
+        loop->signalPipe[0] = loop->signalPipe[1] = -1;
+        return false;
+    }
+    // Neither end blocks and neither end is inherited by executed programs
+    for (int i = 0; i < 2; i++) {
+        int flags = fcntl(loop->signalPipe[i], F_GETFL);
+        if (flags == -1 || fcntl(loop->signalPipe[i], F_SETFL, flags | O_NONBLOCK) == -1 ||
+            fcntl(loop->signalPipe[i], F_SETFD, FD_CLOEXEC) == -1) {
+            event_loop_free(loop);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t event_loop_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+void event_loop_start_timer(event_loop_t * loop, int32_t timer, uint32_t delay) {
+    if (timer >= 0 && (uint32_t)timer < loop->timerCount) {
+        // The deadline 0 marks a timer that is not running
+        loop->timers[timer].deadline = event_loop_now() + delay;
+    }
+}
+
+void event_loop_unwatch(event_loop_t * loop, int fileDescriptor) {
+    for (uint32_t i = 0; i < loop->watchCount; i++) {
+        if (loop->watches[i].fileDescriptor == fileDescriptor) {
+            loop->watches[i] = loop->watches[--loop->watchCount];
+            return;
+        }
+    }
+}
+
+bool event_loop_wait(event_loop_t * loop, int fileDescriptor, int32_t timeout) {
+    struct pollfd descriptors[2 + EVENT_LOOP_MAXIMUM_WATCHES] = {
+        {fileDescriptor, POLLIN, 0},
+        {loop->signalPipe[0], POLLIN, 0},
+    };
+    uint32_t watchCount = loop->watchCount;
+    for (uint32_t i = 0; i < watchCount; i++) {
+        descriptors[2 + i] = (struct pollfd){loop->watches[i].fileDescriptor, POLLIN, 0};
+    }
+    int result = poll(descriptors, 2 + watchCount, event_loop_poll_timeout(loop, timeout));
+    if (result == -1 && errno != EINTR) {
+        return false;
+    }
+    if (result > 0) {
+        event_loop_dispatch_watches(loop, &descriptors[2], watchCount);
+    }
+    bool dispatched = false;
+    if (result > 0 && descriptors[1].revents) {
+        event_loop_dispatch_signals(loop);
+        dispatched = true;
+    }
+    uint64_t now = event_loop_now();
+    for (uint32_t i = 0; i < loop->timerCount; i++) {
+        if (loop->timers[i].deadline && loop->timers[i].deadline <= now) {
+            dispatched = true;
+        }
+    }
+    if (dispatched) {
+        event_loop_dispatch_timers(loop);
+        return false;
+    }
+    return result > 0 && descriptors[0].revents;
+}
+
+bool event_loop_watch(event_loop_t * loop, int fileDescriptor, event_loop_callback_t callback) {
+    if (loop->watchCount == EVENT_LOOP_MAXIMUM_WATCHES) {
+        return false;
+    }
+    loop->watches[loop->watchCount].fileDescriptor = fileDescriptor;
+    loop->watches[loop->watchCount++].callback = callback;
+    return true;
+}
+
+/// @brief Calls the callbacks of the signals, that were received
+/// @param loop The event loop where the signals are handled
+static void event_loop_dispatch_signals(event_loop_t * loop) {
+    unsigned char received[64];
+    ssize_t count;
+    while ((count = read(loop->signalPipe[0], received, sizeof(received))) > 0) {
+        for (ssize_t i = 0; i < count; i++) {
+            for (uint32_t j = 0; j < loop->signalCount; j++) {
+                if (loop->signals[j] == received[i]) {
+                    loop->signalCallbacks[j]();
+                }
+            }
+        }
+    }
+}
+
+/// @brief Calls the callbacks of the timers, that expired
+/// @param loop The event loop where the timers are handled
+static void event_loop_dispatch_timers(event_loop_t * loop) {
+    uint64_t now = event_loop_now();
+    for (uint32_t i = 0; i < loop->timerCount; i++) {
+        if (loop->timers[i].deadline && loop->timers[i].deadline <= now) {
+            // The timer is stopped first, so the callback can start it again
+            loop->timers[i].deadline = 0;
+            loop->timers[i].callback();
+        }
+    }
+}
+
+/// @brief Calls the callbacks of the watched file descriptors, that are
+/// readable or hung up
+/// @param loop The event loop where the file descriptors are watched
+/// @param descriptors The polled file descriptors
+/// @param count The amount of polled file descriptors
+static void event_loop_dispatch_watches(event_loop_t * loop, struct pollfd const * descriptors, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (!descriptors[i].revents) {
+            continue;
+        }
+        // A callback can stop watching any file descriptor, so the watch is looked up again
+        for (uint32_t j = 0; j < loop->watchCount; j++) {
+            if (loop->watches[j].fileDescriptor == descriptors[i].fd) {
+                loop->watches[j].callback();
+                break;
+            }
+        }
+    }
+}
+
+/// @brief Writes a received signal to the pipe of the event loop
+/// @param signal The signal that was received
+static void event_loop_forward_signal(int signal) {
+    int savedErrno = errno;
+    unsigned char received = (unsigned char)signal;
+    if (signalPipeInput != -1) {
+        write(signalPipeInput, &received, 1);
+    }
+    errno = savedErrno;
+}
+
+/// @brief Determines how long poll waits, so it returns once the next timer
+/// expires
+/// @param loop The event loop
+/// @param timeout The maximum amount of milliseconds to wait, -1 waits
+/// indefinitely
+/// @return The timeout for poll
+static int event_loop_poll_timeout(event_loop_t * loop, int32_t timeout) {
+    uint64_t now = event_loop_now();
+    for (uint32_t i = 0; i < loop->timerCount; i++) {
+        uint64_t deadline = loop->timers[i].deadline;
+        if (deadline) {
+            int32_t remaining = deadline > now ? (int32_t)(deadline - now) : 0;
+            if (timeout == -1 || remaining < timeout) {
+                timeout = remaining;
+            }
+        }
+    }
+    return timeout;
+}
@@ -0,0 +1,143 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file event_loop.h
+ * @brief File containing the declaration of the event loop and the
+ * corresponding functions.
+ * @details The event loop waits for input on a file descriptor with poll.
+ * Signals are forwarded to the loop through a pipe, so they are handled outside
+ * of the signal handler, together with the timers that expired in the
+ * meantime. Further file descriptors can be watched, like the pipes of executed
+ * programs. Only a single event loop can handle signals at a time.
+ */
+
+#ifndef YATE_EVENT_LOOP_H_
+#define YATE_EVENT_LOOP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Maximum amount of timers of an event loop
+#define EVENT_LOOP_MAXIMUM_TIMERS (8)
+
+/// Maximum amount of signals that are handled by an event loop
+#define EVENT_LOOP_MAXIMUM_SIGNALS (4)
+
+/// Maximum amount of file descriptors that are watched by an event loop
+#define EVENT_LOOP_MAXIMUM_WATCHES (8)
+
+/// Function that is called, once a timer expired, a signal was received or a
+/// watched file descriptor became readable
+typedef void (*event_loop_callback_t)();
+
+/// A timer of an event loop
+typedef struct {
+    /// Point in time when the timer expires in milliseconds, 0 if the timer is
+    /// not running
+    uint64_t deadline;
+    /// Called once the timer expired
+    event_loop_callback_t callback;
+} event_loop_timer_t;
+
+/// A file descriptor that is watched by an event loop
+typedef struct {
+    /// The file descriptor
+    int fileDescriptor;
+    /// Called once the file descriptor is readable or hung up
+    event_loop_callback_t callback;
+} event_loop_watch_t;
+
+/// Event loop
+typedef struct {
+    /// The signal handler writes the received signals to the pipe, the loop
+    /// reads them from it
+    int signalPipe[2];
+    /// The signals that are handled
+    int signals[EVENT_LOOP_MAXIMUM_SIGNALS];
+    /// The callbacks of the signals
+    event_loop_callback_t signalCallbacks[EVENT_LOOP_MAXIMUM_SIGNALS];
+    /// The amount of signals that are handled
+    uint32_t signalCount;
+    /// The timers of the event loop
+    event_loop_timer_t timers[EVENT_LOOP_MAXIMUM_TIMERS];
+    /// The amount of timers
+    uint32_t timerCount;
+    /// The file descriptors that are watched
+    event_loop_watch_t watches[EVENT_LOOP_MAXIMUM_WATCHES];
+    /// The amount of file descriptors that are watched
+    uint32_t watchCount;
+} event_loop_t;
+
+/// @brief Adds a timer to an event loop, the timer is not started
+/// @param loop The event loop where the timer is added
+/// @param callback Called once the timer expired
+/// @return The index of the timer or -1 if the loop has no room for it
+int32_t event_loop_add_timer(event_loop_t * loop, event_loop_callback_t callback);
+
+/// @brief Frees an event loop, the signals are handled by default again
+/// @param loop The event loop that is freed
+void event_loop_free(event_loop_t * loop);
+
+/// @brief Handles a signal in an event loop
+/// @param loop The event loop where the signal is handled
+/// @param signal The signal that is handled
+/// @param callback Called once the signal was received
+/// @return true if the signal is handled, false if not
+bool event_loop_handle_signal(event_loop_t * loop, int signal, event_loop_callback_t callback);
+
+/// @brief Initializes an event loop
+/// @param loop The event loop that is initialized
+/// @return true if the event loop was initialized, false if not
+bool event_loop_init(event_loop_t * loop);
+
+/// @brief Gets the current time of the monotonic clock, that is used by the
+/// timers
+/// @return The current time in milliseconds
+uint64_t event_loop_now();
+
+/// @brief Starts a timer, a timer that is already running is restarted
+/// @param loop The event loop of the timer
+/// @param timer The index of the timer
+/// @param delay The amount of milliseconds until the timer expires
+void event_loop_start_timer(event_loop_t * loop, int32_t timer, uint32_t delay);
+
+/// @brief Stops watching a file descriptor
+/// @param loop The event loop that watches the file descriptor
+/// @param fileDescriptor The file descriptor, that is not watched anymore
+void event_loop_unwatch(event_loop_t * loop, int fileDescriptor);
+
+/// @brief Waits until a file descriptor is readable, while the signals and the
+/// timers of an event loop are handled
+/// @param loop The event loop
+/// @param fileDescriptor The file descriptor
+/// @param timeout The maximum amount of milliseconds to wait, -1 waits
+/// indefinitely
+/// @return true if the file descriptor is readable, false if the timeout
+/// expired or a signal or timer was handled instead
+/// @details The watched file descriptors are handled as well, but they never
+/// hold back the file descriptor that is waited for
+bool event_loop_wait(event_loop_t * loop, int fileDescriptor, int32_t timeout);
+
+/// @brief Watches a file descriptor in an event loop
+/// @param loop The event loop where the file descriptor is watched
+/// @param fileDescriptor The file descriptor that is watched
+/// @param callback Called whenever the file descriptor is readable or hung up,
+/// until it is not watched anymore
+/// @return true if the file descriptor is watched, false if the loop has no
+/// room for it
+bool event_loop_watch(event_loop_t * loop, int fileDescriptor, event_loop_callback_t callback);
+
+#endif
@@ -0,0 +1,112 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_cache.c
+ * @brief File containing the implementation of the frame cache.
+ */
+
+#include "frame_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Offset basis of the 64 bit FNV-1a hash
+#define FRAME_CACHE_FNV_OFFSET_BASIS (14695981039346656037ULL)
+
+/// Prime of the 64 bit FNV-1a hash
+#define FRAME_CACHE_FNV_PRIME        (1099511628211ULL)
+
+/// Hash of the lines whose content is unknown, it never matches a line
+#define FRAME_CACHE_UNKNOWN_LINE     (0ULL)
+
+static uint64_t frame_cache_hash(char const *, size_t);
+
+void frame_cache_complete_frame(frame_cache_t * cache) {
+    cache->valid = cache->lineHashes != NULL;
+}
+
+void frame_cache_free(frame_cache_t * cache) {
+    free(cache->lineHashes);
+    frame_cache_init(cache);
+}
+
+void frame_cache_init(frame_cache_t * cache) {
+    cache->lineHashes = NULL;
+    cache->lineCount = 0;
+    cache->valid = false;
+}
+
+void frame_cache_invalidate(frame_cache_t * cache) {
+    cache->valid = false;
+}
+
+void frame_cache_scroll(frame_cache_t * cache, uint32_t first, uint32_t count, int32_t distance) {
+    if (first + count > cache->lineCount) {
+        return;
+    }
+    uint64_t * region = cache->lineHashes + first;
+    uint32_t shift = distance < 0 ? (uint32_t)-distance : (uint32_t)distance;
+    if (shift >= count) {
+        shift = count;
+    } else if (distance > 0) {
+        memmove(region, region + shift, sizeof(uint64_t) * (count - shift));
+    } else {
+        memmove(region + shift, region, sizeof(uint64_t) * (count - shift));
+    }
+    uint64_t * exposed = distance > 0 ? region + count - shift : region;
+    for (uint32_t i = 0; i < shift; i++) {
+        exposed[i] = FRAME_CACHE_UNKNOWN_LINE;
+    }
+}
+
+void frame_cache_resize(frame_cache_t * cache, uint32_t lineCount) {
+    if (cache->lineCount == lineCount) {
+        return;
+    }
+    uint64_t * lineHashes = realloc(cache->lineHashes, sizeof(uint64_t) * lineCount);
+    if (lineHashes == NULL && lineCount) {
+        frame_cache_free(cache);
+        return;
+    }
+    cache->lineHashes = lineHashes;
+    cache->lineCount = lineCount;
+    cache->valid = false;
+}
+
+bool frame_cache_update_line(frame_cache_t * cache, uint32_t line, char const * content, size_t length) {
+    if (line >= cache->lineCount) {
+        return true;
+    }
+    uint64_t hash = frame_cache_hash(content, length);
+    if (cache->valid && hash != FRAME_CACHE_UNKNOWN_LINE && cache->lineHashes[line] == hash) {
+        return false;
+    }
+    cache->lineHashes[line] = hash;
+    return true;
+}
+
+/// @brief Hashes the content of a line using FNV-1a
+/// @param content The content that is hashed
+/// @param length The length of the content
+/// @return The hash of the content
+static uint64_t frame_cache_hash(char const * content, size_t length) {
+    uint64_t hash = FRAME_CACHE_FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)content[i];
+        hash *= FRAME_CACHE_FNV_PRIME;
+    }
+    return hash;
+}
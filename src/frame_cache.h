@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_cache.h
+ * @brief File containing the declaration of the frame cache and the
+ * corresponding functions.
+ * @details The frame cache remembers a hash of every line, that was sent to the
+ * terminal in the last frame, so only the lines that changed are sent again.
+ * When the terminal scrolls a region of the screen, the hashes are moved along
+ * with the lines.
+ */
+
+#ifndef YATE_FRAME_CACHE_H_
+#define YATE_FRAME_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Frame cache
+typedef struct {
+    /// Hashes of the lines that are currently displayed by the terminal
+    uint64_t * lineHashes;
+    /// The amount of lines on the screen
+    uint32_t lineCount;
+    /// Determines whether the hashes match the content of the screen
+    bool valid;
+} frame_cache_t;
+
+/// @brief Marks the lines stored since the last invalidation as the content of
+/// the screen
+/// @param cache The frame cache where the frame is completed
+void frame_cache_complete_frame(frame_cache_t * cache);
+
+/// @brief Frees a frame cache
+/// @param cache The frame cache that is freed
+void frame_cache_free(frame_cache_t * cache);
+
+/// @brief Initializes a frame cache
+/// @param cache The frame cache that is initialized
+void frame_cache_init(frame_cache_t * cache);
+
+/// @brief Forces the next frame to redraw every line
+/// @param cache The frame cache that is invalidated
+void frame_cache_invalidate(frame_cache_t * cache);
+
+/// @brief Moves the hashes of the lines in a region of the screen, after the
+/// terminal scrolled the region
+/// @param cache The frame cache where the lines are moved
+/// @param first The index of the first line of the region
+/// @param count The amount of lines in the region
+/// @param distance The amount of lines the content is moved up, negative if it
+/// is moved down
+/// @details The lines that are exposed by the scroll are drawn in the next frame
+void frame_cache_scroll(frame_cache_t * cache, uint32_t first, uint32_t count, int32_t distance);
+
+/// @brief Adjusts the amount of lines stored in a frame cache
+/// @param cache The frame cache that is resized
+/// @param lineCount The amount of lines on the screen
+/// @details The cache is invalidated if the amount of lines changed
+void frame_cache_resize(frame_cache_t * cache, uint32_t lineCount);
+
+/// @brief Stores the content of a line of the next frame
+/// @param cache The frame cache where the line is stored
+/// @param line The index of the line on the screen
+/// @param content The bytes that are sent to the terminal to draw the line
+/// @param length The amount of bytes
+/// @return true if the line differs from the line in the last frame, false if
+/// not
+bool frame_cache_update_line(frame_cache_t * cache, uint32_t line, char const * content, size_t length);
+
+#endif
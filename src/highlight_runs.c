@@ -0,0 +1,193 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file highlight_runs.c
+ * @brief File containing the implementation of the run length encoded syntax
+ * highlighting.
+ */
+
+#include "highlight_runs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The maximum amount of characters in a single run
+#define HIGHLIGHT_RUN_MAXIMUM_LENGTH ((1u << 24) - 1)
+
+static uint32_t highlight_runs_count(unsigned char const *, uint32_t);
+static void highlight_runs_push(highlight_run_t *, uint32_t *, unsigned char, uint32_t);
+static void highlight_runs_store(highlight_run_t *, unsigned char const *, uint32_t);
+
+void highlight_runs_decode(highlight_run_t const * runs, uint32_t runCount, unsigned char * groups) {
+    for (uint32_t i = 0; i < runCount; i++) {
+        uint32_t length = highlight_run_length(runs[i]);
+        memset(groups, highlight_run_group(runs[i]), length);
+        groups += length;
+    }
+}
+
+void highlight_runs_decode_range(highlight_run_t const * runs, uint32_t runCount, highlight_runs_cursor_t * cursor,
+                                 uint32_t from, uint32_t length, unsigned char * groups) {
+    uint32_t i = highlight_runs_seek(runs, runCount, cursor, from);
+    for (uint32_t start = cursor->start; length > 0 && i < runCount; i++) {
+        uint32_t offset = from > start ? from - start : 0;
+        uint32_t available = highlight_run_length(runs[i]) - offset;
+        uint32_t count = available < length ? available : length;
+        memset(groups, highlight_run_group(runs[i]), count);
+        groups += count;
+        length -= count;
+        start += highlight_run_length(runs[i]);
+    }
+}
+
+bool highlight_runs_encode(highlight_run_t ** runs, uint32_t * runCount, unsigned char const * groups,
+                           uint32_t length) {
+    // The runs are counted first, so they can be stored without growing the storage repeatedly
+    uint32_t count = highlight_runs_count(groups, length);
+    highlight_run_t * storage = realloc(*runs, sizeof(highlight_run_t) * (count ? count : 1));
+    if (storage == NULL) {
+        return false;
+    }
+    highlight_runs_store(storage, groups, length);
+    *runs = storage;
+    *runCount = count;
+    return true;
+}
+
+uint32_t highlight_runs_seek(highlight_run_t const * runs, uint32_t runCount, highlight_runs_cursor_t * cursor,
+                             uint32_t at) {
+    if (cursor->run > runCount) {
+        cursor->run = cursor->start = 0;
+    }
+    while (cursor->run > 0 && cursor->start > at) {
+        cursor->run--;
+        cursor->start -= highlight_run_length(runs[cursor->run]);
+    }
+    while (cursor->run < runCount && cursor->start + highlight_run_length(runs[cursor->run]) <= at) {
+        cursor->start += highlight_run_length(runs[cursor->run]);
+        cursor->run++;
+    }
+    return cursor->run;
+}
+
+bool highlight_runs_splice(highlight_run_t ** runs, uint32_t * runCount, highlight_runs_cursor_t * cursor,
+                           uint32_t from, uint32_t oldLength, unsigned char const * groups, uint32_t length) {
+    uint32_t count = *runCount;
+    uint32_t first = highlight_runs_seek(*runs, count, cursor, from);
+    uint32_t firstStart = cursor->start;
+    if (first == count || from == firstStart) {
+        // The run before the replaced characters is merged with them, if they are highlighted the same way
+        if (first == 0) {
+            firstStart = from;
+        } else {
+            first--;
+            firstStart -= highlight_run_length((*runs)[first]);
+        }
+    }
+    uint32_t last = highlight_runs_seek(*runs, count, cursor, from + oldLength);
+    uint32_t lastStart = cursor->start;
+    uint32_t suffixLength = 0;
+    if (last < count) {
+        suffixLength = lastStart + highlight_run_length((*runs)[last]) - (from + oldLength);
+        last++;
+    }
+    // The characters before and after the part that are in the same runs are stored as runs of their own
+    uint32_t mergedCount = 0;
+    highlight_run_t * merged = malloc(sizeof(highlight_run_t) * (highlight_runs_count(groups, length) + 2));
+    if (merged == NULL) {
+        return false;
+    }
+    if (from > firstStart) {
+        highlight_runs_push(merged, &mergedCount, highlight_run_group((*runs)[first]), from - firstStart);
+    }
+    for (uint32_t i = 0; i < length;) {
+        uint32_t end = i + 1;
+        while (end < length && groups[end] == groups[i] && end - i < HIGHLIGHT_RUN_MAXIMUM_LENGTH) {
+            end++;
+        }
+        highlight_runs_push(merged, &mergedCount, groups[i], end - i);
+        i = end;
+    }
+    if (suffixLength) {
+        highlight_runs_push(merged, &mergedCount, highlight_run_group((*runs)[last - 1]), suffixLength);
+    }
+    uint32_t newCount = count - (last - first) + mergedCount;
+    if (newCount > count) {
+        highlight_run_t * storage = realloc(*runs, sizeof(highlight_run_t) * newCount);
+        if (storage == NULL) {
+            free(merged);
+            return false;
+        }
+        *runs = storage;
+    }
+    memmove(&(*runs)[first + mergedCount], &(*runs)[last], sizeof(highlight_run_t) * (count - last));
+    memcpy(&(*runs)[first], merged, sizeof(highlight_run_t) * mergedCount);
+    free(merged);
+    *runCount = newCount;
+    // The runs in front of the replaced characters did not change
+    cursor->run = first;
+    cursor->start = firstStart;
+    return true;
+}
+
+/// @brief Counts the runs that are needed to store highlight groups
+/// @param groups The highlight groups of the characters
+/// @param length The amount of characters
+/// @return The amount of runs
+static uint32_t highlight_runs_count(unsigned char const * groups, uint32_t length) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < length; count++) {
+        uint32_t end = i + 1;
+        while (end < length && groups[end] == groups[i] && end - i < HIGHLIGHT_RUN_MAXIMUM_LENGTH) {
+            end++;
+        }
+        i = end;
+    }
+    return count;
+}
+
+/// @brief Appends characters to runs, that are merged with the last run if
+/// they are highlighted the same way
+/// @param runs The runs where the characters are appended
+/// @param runCount The amount of runs, that is updated
+/// @param group The highlight group of the characters
+/// @param length The amount of characters
+static void highlight_runs_push(highlight_run_t * runs, uint32_t * runCount, unsigned char group, uint32_t length) {
+    if (*runCount > 0 && highlight_run_group(runs[*runCount - 1]) == group) {
+        uint32_t previousLength = highlight_run_length(runs[*runCount - 1]);
+        if (previousLength + length <= HIGHLIGHT_RUN_MAXIMUM_LENGTH) {
+            runs[*runCount - 1] = (previousLength + length) << 8 | group;
+            return;
+        }
+    }
+    runs[(*runCount)++] = length << 8 | group;
+}
+
+/// @brief Compresses highlight groups to runs
+/// @param runs Destination for the runs, large enough for all runs
+/// @param groups The highlight groups of the characters
+/// @param length The amount of characters
+static void highlight_runs_store(highlight_run_t * runs, unsigned char const * groups, uint32_t length) {
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < length; run++) {
+        uint32_t end = i + 1;
+        while (end < length && groups[end] == groups[i] && end - i < HIGHLIGHT_RUN_MAXIMUM_LENGTH) {
+            end++;
+        }
+        runs[run] = (end - i) << 8 | groups[i];
+        i = end;
+    }
+}
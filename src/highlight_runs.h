@@ -0,0 +1,113 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file highlight_runs.h
+ * @brief File containing the declaration of the run length encoded syntax
+ * highlighting of a row and the corresponding functions.
+ * @details Instead of storing the highlight group of every character, a row
+ * stores runs of characters that are highlighted the same way. The runs are
+ * drawn directly and only expanded, when a part of the row is highlighted
+ * again.
+ */
+
+#ifndef YATE_HIGHLIGHT_RUNS_H_
+#define YATE_HIGHLIGHT_RUNS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Characters that are highlighted the same way. The upper 24 bits store the
+/// amount of characters, the lower 8 bits the highlight group
+typedef uint32_t highlight_run_t;
+
+/// Position of the run that was accessed last, so the runs close to it are
+/// found without counting all runs in front of them
+typedef struct {
+    /// The index of the run
+    uint32_t run;
+    /// The index of the first character of the run
+    uint32_t start;
+} highlight_runs_cursor_t;
+
+/// @brief Gets the highlight group of a run
+/// @param run The run
+/// @return The highlight group of the characters in the run
+static inline unsigned char highlight_run_group(highlight_run_t run) {
+    return run & 0xff;
+}
+
+/// @brief Gets the amount of characters in a run
+/// @param run The run
+/// @return The amount of characters in the run
+static inline uint32_t highlight_run_length(highlight_run_t run) {
+    return run >> 8;
+}
+
+/// @brief Expands runs to the highlight group of every character
+/// @param runs The runs that are expanded
+/// @param runCount The amount of runs
+/// @param groups Destination for the highlight groups, large enough for all
+/// characters in the runs
+void highlight_runs_decode(highlight_run_t const * runs, uint32_t runCount, unsigned char * groups);
+
+/// @brief Expands the runs of a part of the characters to their highlight
+/// groups
+/// @param runs The runs that are expanded
+/// @param runCount The amount of runs
+/// @param cursor The run that was accessed last, that is moved to the run of
+/// the first character
+/// @param from The index of the first character that is expanded
+/// @param length The amount of characters that are expanded
+/// @param groups Destination for the highlight groups of the characters
+void highlight_runs_decode_range(highlight_run_t const * runs, uint32_t runCount, highlight_runs_cursor_t * cursor,
+                                 uint32_t from, uint32_t length, unsigned char * groups);
+
+/// @brief Compresses the highlight group of every character to runs
+/// @param runs Pointer to the runs, that are reallocated to fit
+/// @param runCount Is set to the amount of runs
+/// @param groups The highlight groups of the characters
+/// @param length The amount of characters
+/// @return true if the runs were stored, false if no memory was available
+/// @details Cursors of the previous runs are no longer valid
+bool highlight_runs_encode(highlight_run_t ** runs, uint32_t * runCount, unsigned char const * groups,
+                           uint32_t length);
+
+/// @brief Determines the run that contains a character
+/// @param runs The runs
+/// @param runCount The amount of runs
+/// @param cursor The run that was accessed last, that is moved to the run of
+/// the character
+/// @param at The index of the character
+/// @return The index of the run, or the amount of runs if the character is
+/// after the last run
+uint32_t highlight_runs_seek(highlight_run_t const * runs, uint32_t runCount, highlight_runs_cursor_t * cursor,
+                             uint32_t at);
+
+/// @brief Replaces the highlight groups of a part of the characters, without
+/// compressing the groups of the other characters again
+/// @param runs Pointer to the runs, that are reallocated to fit
+/// @param runCount The amount of runs, that is updated
+/// @param cursor The run that was accessed last, that is moved to the run in
+/// front of the replaced characters
+/// @param from The index of the first character that is replaced
+/// @param oldLength The amount of characters that are replaced
+/// @param groups The highlight groups of the characters, that replace them
+/// @param length The amount of characters, that replace them
+/// @return true if the runs were stored, false if no memory was available
+bool highlight_runs_splice(highlight_run_t ** runs, uint32_t * runCount, highlight_runs_cursor_t * cursor,
+                           uint32_t from, uint32_t oldLength, unsigned char const * groups, uint32_t length);
+
+#endif
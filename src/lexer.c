@@ -0,0 +1,288 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file lexer.c
+ * @brief File containing the implementation of the lexer.
+ */
+
+#include "lexer.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Operators that separate words, besides whitespace and the null byte
+#define LEXER_OPERATORS ",.()+-/*=~%<>[];"
+
+#ifdef __SSE2__
+static uint32_t lexer_skip_alphanumeric(char const *, uint32_t, uint32_t);
+#endif
+static uint32_t lexer_skip_plain(lexer_t const *, char const *, uint32_t, uint32_t);
+static uint32_t lexer_skip_string(char const *, uint32_t, uint32_t, char);
+static inline bool lexer_starts_with(char const *, uint32_t, uint32_t, char const *, uint32_t);
+
+void lexer_compile(lexer_t * lexer, editor_syntax_t const * syntax) {
+    lexer->syntax = syntax;
+    memset(lexer->classes, 0, sizeof(lexer->classes));
+    // Bytes outside of ASCII are never separators
+    for (int c = 0; c < 128; c++) {
+        if (isspace(c) || c == '\0' || strchr(LEXER_OPERATORS, c)) {
+            lexer->classes[c] |= LEXER_CLASS_SEPARATOR;
+        }
+    }
+    lexer->singleLineCommentStartLength = lexer->multiLineCommentStartLength = lexer->multiLineCommentEndLength = 0;
+    if (syntax) {
+        if (syntax->singleline_comment_start) {
+            lexer->singleLineCommentStartLength = strlen(syntax->singleline_comment_start);
+        }
+        if (syntax->multiline_comment_start && syntax->multiline_comment_end) {
+            lexer->multiLineCommentStartLength = strlen(syntax->multiline_comment_start);
+            lexer->multiLineCommentEndLength = strlen(syntax->multiline_comment_end);
+        }
+        if (lexer->singleLineCommentStartLength) {
+            lexer->classes[(unsigned char)syntax->singleline_comment_start[0]] |= LEXER_CLASS_DELIMITER;
+        }
+        if (lexer->multiLineCommentStartLength && lexer->multiLineCommentEndLength) {
+            lexer->classes[(unsigned char)syntax->multiline_comment_start[0]] |= LEXER_CLASS_DELIMITER;
+        }
+        if (syntax->flags & SYNTAX_HIGHLIGHT_STRINGS) {
+            lexer->classes['"'] |= LEXER_CLASS_QUOTE;
+            lexer->classes['\''] |= LEXER_CLASS_QUOTE;
+        }
+    }
+    // Delimiters like REM start with letters, words of those languages are looked at byte by byte
+    lexer->alphanumericPlain = !lexer->classes['_'];
+    for (int c = 0; c < 256; c++) {
+        if (c >= 0x80 || isalnum(c)) {
+            lexer->alphanumericPlain = lexer->alphanumericPlain && !lexer->classes[c];
+        }
+    }
+}
+
+bool lexer_highlight(lexer_t const * lexer, char const * text, uint32_t length, unsigned char * highLight,
+                     uint32_t from, bool insideComment, uint32_t resumeAfter, bool resumedState, uint32_t * stop) {
+    editor_syntax_t const * syntax = lexer->syntax;
+    bool multiLineComments = lexer->multiLineCommentStartLength && lexer->multiLineCommentEndLength;
+    bool previousSeparator = true;
+    char insideString = 0;
+    uint32_t i = from;
+    while (i < length) {
+        if (insideComment && multiLineComments) {
+            // Only the first byte of the end delimiter can end the comment
+            char const * candidate = memchr(&text[i], syntax->multiline_comment_end[0], length - i);
+            uint32_t next = candidate ? (uint32_t)(candidate - text) : length;
+            memset(&highLight[i], HIGHLIGHT_MLCOMMENT, next - i);
+            i = next;
+            if (i == length) {
+                break;
+            }
+            if (lexer_starts_with(text, length, i, syntax->multiline_comment_end, lexer->multiLineCommentEndLength)) {
+                memset(&highLight[i], HIGHLIGHT_MLCOMMENT, lexer->multiLineCommentEndLength);
+                i += lexer->multiLineCommentEndLength;
+                insideComment = false;
+                previousSeparator = true;
+            } else {
+                highLight[i++] = HIGHLIGHT_MLCOMMENT;
+            }
+            continue;
+        }
+        if (insideString) {
+            // Only quotes and escapes change the state of a string
+            uint32_t next = lexer_skip_string(text, i, length, insideString);
+            memset(&highLight[i], HIGHLIGHT_STRING, next - i);
+            previousSeparator = previousSeparator || next > i;
+            i = next;
+            if (i == length) {
+                break;
+            }
+            highLight[i] = HIGHLIGHT_STRING;
+            if (text[i] == '\\' && i + 1 < length) {
+                highLight[i + 1] = HIGHLIGHT_STRING;
+                i += 2;
+                continue;
+            }
+            if (text[i] == insideString) {
+                insideString = 0;
+            }
+            i++;
+            previousSeparator = true;
+            continue;
+        }
+        unsigned char c = (unsigned char)text[i];
+        uint8_t class = lexer->classes[c];
+        unsigned char previousHighlighting = (i > 0) ? highLight[i - 1] : HIGHTLIGHT_NORMAL;
+        if (class & LEXER_CLASS_DELIMITER) {
+            if (lexer->singleLineCommentStartLength && !insideComment &&
+                lexer_starts_with(text, length, i, syntax->singleline_comment_start,
+                                  lexer->singleLineCommentStartLength)) {
+                memset(&highLight[i], HIGHLIGHT_COMMENT, length - i);
+                break;
+            }
+            if (multiLineComments && lexer_starts_with(text, length, i, syntax->multiline_comment_start,
+                                                       lexer->multiLineCommentStartLength)) {
+                memset(&highLight[i], HIGHLIGHT_MLCOMMENT, lexer->multiLineCommentStartLength);
+                i += lexer->multiLineCommentStartLength;
+                insideComment = true;
+                continue;
+            }
+        }
+        if (class & LEXER_CLASS_QUOTE) {
+            insideString = (char)c;
+            highLight[i++] = HIGHLIGHT_STRING;
+            continue;
+        }
+        if (syntax->flags & SYNTAX_HIGHLIGHT_NUMBERS) {
+            bool digit = c >= '0' && c <= '9';
+            if ((digit && (previousSeparator || previousHighlighting == HIGHLIGHT_NUMBER)) ||
+                (c == '.' && previousHighlighting == HIGHLIGHT_NUMBER)) {
+                highLight[i++] = HIGHLIGHT_NUMBER;
+                previousSeparator = false;
+                continue;
+            }
+        }
+        if (previousSeparator) {
+            // Keywords never contain separators, so the word up to the next separator is the only candidate
+            uint32_t wordLength = 0;
+            while (i + wordLength < length && !lexer_is_separator(lexer, (unsigned char)text[i + wordLength])) {
+                wordLength++;
+            }
+            editorHighlight keywordGroup =
+                wordLength ? syntax_lookup_keyword(syntax, &text[i], wordLength) : HIGHTLIGHT_NORMAL;
+            if (keywordGroup != HIGHTLIGHT_NORMAL) {
+                memset(&highLight[i], keywordGroup, wordLength);
+                i += wordLength;
+                previousSeparator = false;
+                continue;
+            }
+        }
+        previousSeparator = class & LEXER_CLASS_SEPARATOR;
+        if (previousSeparator && i >= resumeAfter && highLight[i] == HIGHTLIGHT_NORMAL) {
+            // The lexer is in the same state as the last time it highlighted the row
+            if (stop) {
+                *stop = i;
+            }
+            return resumedState;
+        }
+        highLight[i++] = HIGHTLIGHT_NORMAL;
+        if (!previousSeparator) {
+            // The rest of the word is normal text, up to the next byte that has a class
+            uint32_t next = lexer_skip_plain(lexer, text, i, length);
+            memset(&highLight[i], HIGHTLIGHT_NORMAL, next - i);
+            i = next;
+        }
+    }
+    if (stop) {
+        *stop = length;
+    }
+    return insideComment;
+}
+
+#ifdef __SSE2__
+/// @brief Skips letters, digits, underscores and non ASCII bytes in blocks of
+/// 16 bytes
+/// @param text The characters of the row
+/// @param i The index where the skipping starts
+/// @param length The amount of characters
+/// @return The index of the first other byte, or of the first byte of the last
+/// incomplete block
+static uint32_t lexer_skip_alphanumeric(char const * text, uint32_t i, uint32_t length) {
+    __m128i const caseBit = _mm_set1_epi8(0x20);
+    while (i + 16 <= length) {
+        __m128i block = _mm_loadu_si128((__m128i const *)&text[i]);
+        __m128i lower = _mm_or_si128(block, caseBit);
+        // Non ASCII bytes are negative as signed bytes
+        __m128i plain = _mm_cmplt_epi8(block, _mm_setzero_si128());
+        plain = _mm_or_si128(plain, _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+                                                  _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1))));
+        plain = _mm_or_si128(plain, _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                                  _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+        plain = _mm_or_si128(plain, _mm_cmpeq_epi8(block, _mm_set1_epi8('_')));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(plain);
+        if (mask != 0xffff) {
+            return i + (uint32_t)__builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+    return i;
+}
+#endif
+
+/// @brief Skips bytes that have no class
+/// @param lexer The lexer of the language
+/// @param text The characters of the row
+/// @param i The index where the skipping starts
+/// @param length The amount of characters
+/// @return The index of the first byte that has a class, or the length
+static uint32_t lexer_skip_plain(lexer_t const * lexer, char const * text, uint32_t i, uint32_t length) {
+    while (i < length) {
+#ifdef __SSE2__
+        if (lexer->alphanumericPlain) {
+            i = lexer_skip_alphanumeric(text, i, length);
+            if (i == length) {
+                break;
+            }
+        }
+#endif
+        if (lexer->classes[(unsigned char)text[i]]) {
+            break;
+        }
+        i++;
+    }
+    return i;
+}
+
+/// @brief Skips the bytes of a string, that neither end the string nor escape
+/// the next byte
+/// @param text The characters of the row
+/// @param i The index where the skipping starts
+/// @param length The amount of characters
+/// @param quote The quote that ends the string
+/// @return The index of the first quote or backslash, or the length
+static uint32_t lexer_skip_string(char const * text, uint32_t i, uint32_t length, char quote) {
+#ifdef __SSE2__
+    __m128i const quotes = _mm_set1_epi8(quote);
+    __m128i const escapes = _mm_set1_epi8('\\');
+    while (i + 16 <= length) {
+        __m128i block = _mm_loadu_si128((__m128i const *)&text[i]);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quotes), _mm_cmpeq_epi8(block, escapes)));
+        if (mask) {
+            return i + (uint32_t)__builtin_ctz(mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length && text[i] != quote && text[i] != '\\') {
+        i++;
+    }
+    return i;
+}
+
+/// @brief Determines whether a delimiter starts at a position of a row
+/// @param text The characters of the row
+/// @param length The amount of characters
+/// @param at The position in the row
+/// @param delimiter The delimiter
+/// @param delimiterLength The length of the delimiter
+/// @return true if the row contains the delimiter at that position, false if
+/// not
+static inline bool lexer_starts_with(char const * text, uint32_t length, uint32_t at, char const * delimiter,
+                                     uint32_t delimiterLength) {
+    return length - at >= delimiterLength && !memcmp(&text[at], delimiter, delimiterLength);
+}
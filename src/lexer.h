@@ -0,0 +1,96 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file lexer.h
+ * @brief File containing the declaration of the lexer, that applies the syntax
+ * highlighting to a row, and the corresponding functions.
+ * @details A lexer is compiled from the syntax of a language. Every byte is
+ * classified by a table, so comment delimiters are only compared at bytes that
+ * can start them. Stretches of plain text, strings and multiline comments are
+ * skipped without looking at every byte on its own.
+ */
+
+#ifndef YATE_LEXER_H_
+#define YATE_LEXER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "syntax.h"
+
+/// The byte separates words - whitespace and operators
+#define LEXER_CLASS_SEPARATOR (1 << 0)
+
+/// The byte is the first byte of a single line comment delimiter or the start
+/// delimiter of a multiline comment
+#define LEXER_CLASS_DELIMITER (1 << 1)
+
+/// The byte starts or ends a string
+#define LEXER_CLASS_QUOTE     (1 << 2)
+
+/// Lexer of a language
+typedef struct {
+    /// The language the lexer was compiled from - NULL if the lexer highlights
+    /// nothing
+    editor_syntax_t const * syntax;
+    /// The class of every byte
+    uint8_t classes[256];
+    /// The length of the delimiter of a single line comment
+    uint32_t singleLineCommentStartLength;
+    /// The length of the start delimiter of a multiline comment
+    uint32_t multiLineCommentStartLength;
+    /// The length of the end delimiter of a multiline comment
+    uint32_t multiLineCommentEndLength;
+    /// Determines whether letters, digits, underscores and non ASCII bytes are
+    /// plain text, so words can be skipped in blocks
+    bool alphanumericPlain;
+} lexer_t;
+
+/// @brief Compiles the lexer of a language
+/// @param lexer The lexer that is compiled
+/// @param syntax The language - NULL if nothing is highlighted
+void lexer_compile(lexer_t * lexer, editor_syntax_t const * syntax);
+
+/// @brief Applies the syntax highlighting to a part of a row
+/// @param lexer The lexer of the language
+/// @param text The characters of the row
+/// @param length The amount of characters
+/// @param highLight The highlight group of every character, the groups before
+/// the start of the highlighting have to be up to date
+/// @param from The index where the highlighting starts, the lexer must not be
+/// inside of a string or a token at that position
+/// @param insideComment Determines whether the row is inside a multiline
+/// comment at that position
+/// @param resumeAfter Once the lexer passes this index and reaches a separator
+/// that was highlighted as normal text before, the rest of the row is already
+/// highlighted correctly and the highlighting stops
+/// @param resumedState The state at the end of the row, that is returned if the
+/// highlighting stops early
+/// @param stop Is set to the index where the highlighting stopped early, or to
+/// the length if it reached the end of the row - may be NULL
+/// @return true if the row ends inside a multiline comment, false if not
+bool lexer_highlight(lexer_t const * lexer, char const * text, uint32_t length, unsigned char * highLight,
+                     uint32_t from, bool insideComment, uint32_t resumeAfter, bool resumedState, uint32_t * stop);
+
+/// @brief Determines whether a byte separates words
+/// @param lexer The lexer of the language
+/// @param c The byte
+/// @return true if the byte is a separator, false if not
+static inline bool lexer_is_separator(lexer_t const * lexer, unsigned char c) {
+    return lexer->classes[c] & LEXER_CLASS_SEPARATOR;
+}
+
+#endif
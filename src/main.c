@@ -22,6 +22,8 @@
 #define _BSD_SOURCE
 #define _GNU_SOURCE
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -61,16 +63,65 @@ int main(int argc, char const ** argv) {
             return 0;
         }
     }
+    // The options of the session precede the files that are opened
+    char const * tracePath = NULL;
+    bool follow = false;
+    uint32_t maximumRows = 0;
+    int fileArgument = 1;
+    while (fileArgument < argc) {
+        char const * option = argv[fileArgument];
+        char const * value = fileArgument + 1 < argc ? argv[fileArgument + 1] : NULL;
+        if (!strcmp(option, "--follow") || !strcmp(option, "-f")) {
+            follow = true;
+            fileArgument++;
+        } else if (!strcmp(option, "--lines") || !strcmp(option, "-n")) {
+            unsigned long lines = value ? strtoul(value, NULL, 10) : 0;
+            if (!value || !*value || strspn(value, "0123456789") != strlen(value) || lines > UINT32_MAX) {
+                printConsoleHelp();
+                return 1;
+            }
+            maximumRows = (uint32_t)lines;
+            fileArgument += 2;
+        } else if (!strcmp(option, "--trace") || !strcmp(option, "-t")) {
+            if (!value) {
+                printConsoleHelp();
+                return 1;
+            }
+            tracePath = value;
+            fileArgument += 2;
+        } else {
+            break;
+        }
+    }
     configuration_reader_result_t * config = configuration_reader_read_configuration_file();
+    if (!config) {
+        perror("yate");
+        return 1;
+    }
     editor_enable_raw_mode();
     editor_initialize(config);
-    if (argc >= 2) {
-        editor_open(argv[1]);
+    if (tracePath && !editor_start_trace(tracePath)) {
+        perror(tracePath);
+        return 1;
+    }
+    for (int i = fileArgument; i < argc; i++) {
+        if (follow) {
+            editor_follow(argv[i], maximumRows);
+        } else {
+            editor_open(argv[i]);
+        }
+    }
+    // The first file is displayed, the others stay resident
+    if (argc > fileArgument + 1) {
+        editor_open(argv[fileArgument]);
     }
 
     while (1) {
         editor_refresh_screen();
-        editor_process_keypress();
+        // Keys that were typed ahead or held down are processed before the next frame is drawn
+        do {
+            editor_process_keypress();
+        } while (editor_has_pending_input());
     }
     return 0;
 }
@@ -78,31 +129,44 @@ int main(int argc, char const ** argv) {
 /// @brief Displays the help of the editor in the console
 static void printConsoleHelp() {
     printf("%s version %d.%d\n", PROJECT_NAME, PROJECT_VERSION_MAJOR, PROJECT_VERSION_MINOR);
-    printf("Usage yate <option> <filepath>\n\n");
+    printf("Usage yate <option> <filepath>...\n");
+    printf("      yate --trace <tracepath> <filepath>...\n");
+    printf("      yate --follow [--lines <count>] <filepath>...\n\n");
     printf("Options\n");
     printf("  -c, --config\t\tShows configurable settings of the editor\n");
+    printf("  -f, --follow\t\tAdds the lines that are appended to the files to the opened files\n");
     printf("  -h, --help\t\tDisplay this help\n");
     printf("  -k, --key\t\tShows hotkeys of the editor\n");
+    printf("  -n, --lines\t\tKeeps only the last count lines of the followed files\n");
+    printf("  -t, --trace\t\tWrites the measurements of every keypress and frame to a file\n");
     printf("  -v, --version\t\tShows the version of the installed editor\n");
 }
 
 /// @brief Displays the available hotkeys of the editor
 static void printHotKeys() {
     printf("HotKeys\n");
-    printf("  ctrl-d\t\tYanks and deletes the current line\n");
+    printf("  ctrl-d\t\tYanks and deletes the current line or the marked lines\n");
     printf("  ctrl-f\t\tFind occurences in file\n");
+    printf("  ctrl-g\t\tReplaces all occurences of a word in the file\n");
     printf("  ctrl-h\t\tShows help\n");
-    printf("  ctrl-o\t\tOpens file\n");
+    printf("  ctrl-k\t\tMarks the current line as the start of a range of lines\n");
+    printf("  ctrl-n\t\tShows the next opened file\n");
+    printf("  ctrl-o\t\tOpens file, or shows it if it was opened already\n");
     printf("  ctrl-p\t\tPaste last yanked content\n");
     printf("  ctrl-q\t\tExit the editor\n");
+    printf("  ctrl-r\t\tSelects the register a-z for the next yank, delete or paste\n");
     printf("  ctrl-s\t\tSaves the currently opened file\n");
-    printf("  ctrl-x\t\tExecute the currently opened file\n");
-    printf("  ctrl-y\t\tYank the current line\n");
+    printf("  ctrl-t\t\tShows the timings of the last frame in the status bar\n");
+    printf("  ctrl-w\t\tCloses the currently opened file\n");
+    printf("  ctrl-x\t\tExecute the currently opened file (Cellox, JBASIC, lua or python)\n");
+    printf("  ctrl-y\t\tYank the current line or the marked lines\n");
 }
 
 /// @brief Displays the configurable settings of the editor
 static void printSettings() {
     printf("Settings\n");
+    printf("  COLOR_MODE\t\t\tColors the terminal supports: auto, truecolor, 256, 16 or monochrome\n");
+    printf("  MEMORY_BUDGET\t\t\tMegabytes the rendered and highlighted rows may use, 0 is unlimited\n");
     printf("  STATUS_MESSAGE_DURATION\tDuration in seconds for how long a status "
            "message will be displayed\n");
     printf("  TAB_STOP_SIZE\t\t\tSize of a tabstop converted to white space's\n");
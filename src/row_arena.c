@@ -0,0 +1,65 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file row_arena.c
+ * @brief File containing the implementation of the row arena.
+ */
+
+#include "row_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The size of a block of a row arena, rows that are longer get their own block
+#define ROW_ARENA_BLOCK_SIZE (1 << 20)
+
+void row_arena_free(row_arena_t * arena) {
+    while (arena->current) {
+        row_arena_block_t * previous = arena->current->previous;
+        free(arena->current);
+        arena->current = previous;
+    }
+}
+
+void row_arena_init(row_arena_t * arena) {
+    arena->current = NULL;
+}
+
+char * row_arena_store(row_arena_t * arena, char const * chars, size_t length) {
+    row_arena_block_t * block = arena->current;
+    if (block == NULL || block->capacity - block->used < length + 1) {
+        size_t capacity = length + 1 > ROW_ARENA_BLOCK_SIZE ? length + 1 : ROW_ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(row_arena_block_t) + capacity);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->capacity = capacity;
+        if (arena->current && capacity > ROW_ARENA_BLOCK_SIZE) {
+            // Blocks of long rows are inserted behind the current block, so the space left in it is still used
+            block->previous = arena->current->previous;
+            arena->current->previous = block;
+        } else {
+            block->previous = arena->current;
+            arena->current = block;
+        }
+    }
+    char * copy = &block->data[block->used];
+    memcpy(copy, chars, length);
+    copy[length] = '\0';
+    block->used += length + 1;
+    return copy;
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file row_arena.h
+ * @brief File containing the declaration of the row arena and the
+ * corresponding functions.
+ * @details The row arena stores the characters of the rows that were read from
+ * a file in large blocks, instead of allocating every row separately. The
+ * contents of the arena are only freed all at once.
+ */
+
+#ifndef YATE_ROW_ARENA_H_
+#define YATE_ROW_ARENA_H_
+
+#include <stddef.h>
+
+/// A single block of a row arena
+typedef struct row_arena_block_t {
+    /// The block that was allocated before this block
+    struct row_arena_block_t * previous;
+    /// The amount of bytes that are in use
+    size_t used;
+    /// The amount of bytes that fit into the block
+    size_t capacity;
+    /// The contents of the block
+    char data[];
+} row_arena_block_t;
+
+/// Row arena
+typedef struct {
+    /// The block that was allocated last, new rows are stored in it
+    row_arena_block_t * current;
+} row_arena_t;
+
+/// @brief Frees all the rows of a row arena
+/// @param arena The row arena that is freed
+void row_arena_free(row_arena_t * arena);
+
+/// @brief Initializes a row arena
+/// @param arena The row arena that is initialized
+void row_arena_init(row_arena_t * arena);
+
+/// @brief Stores a copy of the characters of a row in a row arena
+/// @param arena The row arena where the characters are stored
+/// @param chars The characters that are stored
+/// @param length The amount of characters
+/// @return Pointer to the null terminated copy or NULL if no memory was
+/// available
+char * row_arena_store(row_arena_t * arena, char const * chars, size_t length);
+
+#endif
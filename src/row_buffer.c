@@ -0,0 +1,132 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file row_buffer.c
+ * @brief File containing the implementation of the row buffer.
+ */
+
+#include "row_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Initial capacity of a row buffer
+#define ROW_BUFFER_INITIAL_CAPACITY (64)
+
+static bool row_buffer_grow(row_buffer_t *, uint32_t);
+static void row_buffer_move_gap(row_buffer_t *, uint32_t);
+
+void row_buffer_free(row_buffer_t * buffer) {
+    free(buffer->rows ? buffer->rows - buffer->frontSlots : NULL);
+    row_buffer_init(buffer);
+}
+
+void row_buffer_init(row_buffer_t * buffer) {
+    buffer->rows = NULL;
+    buffer->capacity = buffer->gapStart = buffer->gapEnd = buffer->frontSlots = 0;
+}
+
+editor_row_t * row_buffer_insert(row_buffer_t * buffer, uint32_t at) {
+    if (buffer->gapStart == buffer->gapEnd && !row_buffer_grow(buffer, 1)) {
+        return NULL;
+    }
+    row_buffer_move_gap(buffer, at);
+    return &buffer->rows[buffer->gapStart++];
+}
+
+editor_row_t * row_buffer_insert_range(row_buffer_t * buffer, uint32_t at, uint32_t count) {
+    if (buffer->gapEnd - buffer->gapStart < count && !row_buffer_grow(buffer, count)) {
+        return NULL;
+    }
+    row_buffer_move_gap(buffer, at);
+    editor_row_t * rows = &buffer->rows[buffer->gapStart];
+    buffer->gapStart += count;
+    return rows;
+}
+
+void row_buffer_remove(row_buffer_t * buffer, uint32_t at) {
+    row_buffer_remove_range(buffer, at, 1);
+}
+
+void row_buffer_remove_range(row_buffer_t * buffer, uint32_t at, uint32_t count) {
+    if (at == 0 && count <= buffer->gapStart) {
+        // The storage starts after the removed rows, their slots are reclaimed later on
+        buffer->rows += count;
+        buffer->capacity -= count;
+        buffer->gapStart -= count;
+        buffer->gapEnd -= count;
+        buffer->frontSlots += count;
+        return;
+    }
+    row_buffer_move_gap(buffer, at);
+    buffer->gapEnd += count;
+}
+
+/// @brief Doubles the capacity of a row buffer, or grows it further if that is
+/// not enough - the free slots in front of the storage are reclaimed first
+/// @param buffer The row buffer that is grown
+/// @param count The amount of rows, that have to fit into the gap afterwards
+/// @return true if the buffer was grown, false if no memory was available
+static bool row_buffer_grow(row_buffer_t * buffer, uint32_t count) {
+    if (buffer->frontSlots) {
+        // The rows in front of the gap are moved back to the start of the storage, the gap absorbs the free slots
+        uint32_t frontSlots = buffer->frontSlots;
+        memmove(buffer->rows - frontSlots, buffer->rows, sizeof(editor_row_t) * buffer->gapStart);
+        buffer->rows -= frontSlots;
+        buffer->capacity += frontSlots;
+        buffer->gapEnd += frontSlots;
+        buffer->frontSlots = 0;
+        // Growing is avoided, if at least half of the storage was reclaimed, so no more rows are moved than were
+        // removed
+        if (frontSlots >= buffer->capacity / 2 && buffer->gapEnd - buffer->gapStart >= count) {
+            return true;
+        }
+    }
+    uint32_t newCapacity = buffer->capacity ? buffer->capacity * 2 : ROW_BUFFER_INITIAL_CAPACITY;
+    uint32_t minimumCapacity = buffer->capacity - (buffer->gapEnd - buffer->gapStart) + count;
+    if (newCapacity < minimumCapacity) {
+        newCapacity = minimumCapacity;
+    }
+    editor_row_t * rows = realloc(buffer->rows, sizeof(editor_row_t) * newCapacity);
+    if (rows == NULL) {
+        return false;
+    }
+    // Rows after the gap are moved to the end of the new storage, the gap absorbs the added capacity
+    uint32_t tailLength = buffer->capacity - buffer->gapEnd;
+    memmove(&rows[newCapacity - tailLength], &rows[buffer->gapEnd], sizeof(editor_row_t) * tailLength);
+    buffer->gapEnd = newCapacity - tailLength;
+    buffer->rows = rows;
+    buffer->capacity = newCapacity;
+    return true;
+}
+
+/// @brief Moves the gap of a row buffer, so it starts at the specified logical
+/// index
+/// @param buffer The row buffer where the gap is moved
+/// @param at The logical index where the gap is moved to
+static void row_buffer_move_gap(row_buffer_t * buffer, uint32_t at) {
+    if (at < buffer->gapStart) {
+        uint32_t distance = buffer->gapStart - at;
+        buffer->gapEnd -= distance;
+        buffer->gapStart = at;
+        memmove(&buffer->rows[buffer->gapEnd], &buffer->rows[at], sizeof(editor_row_t) * distance);
+    } else if (at > buffer->gapStart) {
+        uint32_t distance = at - buffer->gapStart;
+        memmove(&buffer->rows[buffer->gapStart], &buffer->rows[buffer->gapEnd], sizeof(editor_row_t) * distance);
+        buffer->gapStart = at;
+        buffer->gapEnd += distance;
+    }
+}
@@ -0,0 +1,144 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file row_buffer.h
+ * @brief File containing the declaration of the row buffer and the
+ * corresponding functions.
+ * @details The row buffer is a gap buffer of editor rows. Inserting or deleting
+ * rows close to the last edit only moves the rows between the old and the new
+ * gap position, so editing near the cursor is O(1) amortized regardless of the
+ * size of the file.
+ */
+
+#ifndef YATE_ROW_BUFFER_H_
+#define YATE_ROW_BUFFER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "column_map.h"
+#include "highlight_runs.h"
+
+/// Models a single line that is rendered by the editor
+typedef struct {
+    /// The amount of characters stored in the underlying character buffer
+    uint32_t size;
+    /// The amount of characters stored in the render buffer, that was created
+    /// with the underlying character buffer
+    uint32_t renderSize;
+    /// The underlying character buffer
+    char * chars;
+    /// The render buffer, that was created with the underlying character buffer
+    char * render;
+    /// The syntax highlighting of the render buffer
+    highlight_run_t * highLightRuns;
+    /// The amount of runs in the syntax highlighting
+    uint32_t highLightRunCount;
+    /// The run of the syntax highlighting that was accessed last
+    highlight_runs_cursor_t highLightCursor;
+    /// Checkpoints of the columns where the characters are displayed, only
+    /// created for long rows once they are needed
+    column_map_t * columnMap;
+    /// The number of the frame the row was used for last, the rows that were
+    /// used least recently are released first
+    uint32_t lastUse;
+    /// Determines whether the row is part of a multiline comment
+    bool hightLightOpenComment;
+    /// Determines whether the underlying character buffer points into storage
+    /// that is not owned by the row - the memory mapped file or the row arena
+    bool mapped;
+    /// Determines whether the render buffer is the underlying character buffer,
+    /// because the row contains no tabs
+    bool renderAliased;
+    /// Determines whether the underlying character buffer is still being
+    /// written by a save in progress
+    bool shared;
+} editor_row_t;
+
+/// Gap buffer of editor rows
+typedef struct {
+    /// The underlying storage, including the gap
+    editor_row_t * rows;
+    /// The amount of rows that fit into the storage
+    uint32_t capacity;
+    /// Index of the first slot of the gap
+    uint32_t gapStart;
+    /// Index of the first slot after the gap
+    uint32_t gapEnd;
+    /// The amount of free slots in front of the storage, that were left by rows
+    /// removed from the front - they are reclaimed once the gap is full
+    uint32_t frontSlots;
+} row_buffer_t;
+
+/// @brief Gets the row at a logical position in a row buffer
+/// @param buffer The row buffer that contains the row
+/// @param at The logical index of the row
+/// @return Pointer to the row, that is valid until the next insertion or
+/// deletion
+static inline editor_row_t * row_buffer_at(row_buffer_t * buffer, uint32_t at) {
+    return at < buffer->gapStart ? &buffer->rows[at] : &buffer->rows[at + (buffer->gapEnd - buffer->gapStart)];
+}
+
+/// @brief Gets the amount of rows stored in a row buffer
+/// @param buffer The row buffer where the rows are counted
+/// @return The number of rows in the buffer
+static inline uint32_t row_buffer_count(row_buffer_t const * buffer) {
+    return buffer->capacity - (buffer->gapEnd - buffer->gapStart);
+}
+
+/// @brief Frees the storage of a row buffer
+/// @param buffer The row buffer that is freed
+/// @details The contents of the rows are not freed
+void row_buffer_free(row_buffer_t * buffer);
+
+/// @brief Initializes a row buffer
+/// @param buffer The row buffer that is initialized
+void row_buffer_init(row_buffer_t * buffer);
+
+/// @brief Makes room for a new row in a row buffer
+/// @param buffer The row buffer where the row is inserted
+/// @param at The logical index of the new row
+/// @return Pointer to the uninitialized row or NULL if the buffer could not
+/// grow
+editor_row_t * row_buffer_insert(row_buffer_t * buffer, uint32_t at);
+
+/// @brief Makes room for several consecutive new rows in a row buffer at once
+/// @param buffer The row buffer where the rows are inserted
+/// @param at The logical index of the first new row
+/// @param count The amount of new rows
+/// @return Pointer to the first of the uninitialized rows, that follow each
+/// other in memory, or NULL if the buffer could not grow
+/// @details The storage grows at most once, so loading a file does not copy
+/// the rows that were inserted before
+editor_row_t * row_buffer_insert_range(row_buffer_t * buffer, uint32_t at, uint32_t count);
+
+/// @brief Removes a row from a row buffer
+/// @param buffer The row buffer where the row is removed
+/// @param at The logical index of the row that is removed
+/// @details The contents of the row are not freed
+void row_buffer_remove(row_buffer_t * buffer, uint32_t at);
+
+/// @brief Removes several consecutive rows from a row buffer at once
+/// @param buffer The row buffer where the rows are removed
+/// @param at The logical index of the first row that is removed
+/// @param count The amount of rows that are removed
+/// @details The contents of the rows are not freed. Rows in front of the gap
+/// are removed from the front without moving any rows, so the oldest rows of
+/// a followed file are dropped in constant time while rows are appended
+void row_buffer_remove_range(row_buffer_t * buffer, uint32_t at, uint32_t count);
+
+#endif
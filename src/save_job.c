@@ -0,0 +1,278 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file save_job.c
+ * @brief File containing the implementation of the save job.
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+#define _GNU_SOURCE
+
+#include "save_job.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "project_config.h"
+
+/// Amount of rows that are written with a single system call
+#define SAVE_JOB_BATCH_SIZE (512)
+
+static void save_job_clear(save_job_t *);
+static int save_job_copy_lines(save_job_t *, save_job_copy_t const *, int);
+static void * save_job_run(void *);
+static int save_job_write_lines(save_job_t *, int, uint32_t, uint32_t);
+
+bool save_job_defer_free(save_job_t * job, void * buffer) {
+    if (job->deferredCount == job->deferredCapacity) {
+        uint32_t newCapacity = job->deferredCapacity ? job->deferredCapacity * 2 : 64;
+        void ** deferredBuffers = realloc(job->deferredBuffers, sizeof(void *) * newCapacity);
+        if (deferredBuffers == NULL) {
+            return false;
+        }
+        job->deferredBuffers = deferredBuffers;
+        job->deferredCapacity = newCapacity;
+    }
+    job->deferredBuffers[job->deferredCount++] = buffer;
+    return true;
+}
+
+void save_job_free(save_job_t * job) {
+    save_job_reset(job);
+    pthread_mutex_destroy(&job->lock);
+}
+
+void save_job_init(save_job_t * job) {
+    save_job_clear(job);
+    pthread_mutex_init(&job->lock, NULL);
+}
+
+bool save_job_poll(save_job_t * job) {
+    if (!job->running) {
+        return false;
+    }
+    pthread_mutex_lock(&job->lock);
+    bool finished = job->finished;
+    pthread_mutex_unlock(&job->lock);
+    if (finished) {
+        save_job_wait(job);
+    }
+    return finished;
+}
+
+void save_job_reset(save_job_t * job) {
+    for (uint32_t i = 0; i < job->deferredCount; i++) {
+        free(job->deferredBuffers[i]);
+    }
+    free(job->deferredBuffers);
+    free(job->lines);
+    free(job->copies);
+    free(job->path);
+    save_job_clear(job);
+}
+
+bool save_job_start(save_job_t * job, char const * path, struct iovec * lines, uint32_t lineCount,
+                    int sourceFileDescriptor, save_job_copy_t * copies, uint32_t copyCount) {
+    job->lines = lines;
+    job->lineCount = lineCount;
+    job->sourceFileDescriptor = sourceFileDescriptor;
+    job->copies = copies;
+    job->copyCount = copies ? copyCount : 0;
+    job->path = strdup(path);
+    job->bytesWritten = 0;
+    job->error = 0;
+    job->finished = false;
+    if (job->path == NULL) {
+        job->error = ENOMEM;
+        return false;
+    }
+    // An existing file keeps it's permissions, a new one is created like open would do
+    struct stat fileStatus;
+    if (stat(path, &fileStatus) == 0) {
+        job->mode = fileStatus.st_mode & 07777;
+    } else {
+        mode_t mask = umask(0);
+        umask(mask);
+        job->mode = 0644 & ~mask;
+    }
+    job->error = pthread_create(&job->thread, NULL, save_job_run, job);
+    job->running = !job->error;
+    return job->running;
+}
+
+void save_job_wait(save_job_t * job) {
+    if (job->running) {
+        pthread_join(job->thread, NULL);
+        job->running = false;
+    }
+}
+
+/// @brief Resets the fields of a save job, without freeing anything
+/// @param job The save job that is cleared
+static void save_job_clear(save_job_t * job) {
+    job->lines = NULL;
+    job->lineCount = 0;
+    job->copies = NULL;
+    job->copyCount = 0;
+    job->sourceFileDescriptor = -1;
+    job->path = NULL;
+    job->mode = 0;
+    job->deferredBuffers = NULL;
+    job->deferredCount = job->deferredCapacity = 0;
+    job->bytesWritten = 0;
+    job->error = 0;
+    job->running = job->finished = false;
+}
+
+/// @brief Copies a range of rows from the opened file to the written file
+/// @param job The save job that's rows are copied
+/// @param copy The range of rows that is copied
+/// @param fileDescriptor The file descriptor of the written file
+/// @return 0 if all rows were copied, otherwise the error that occured
+/// @details File systems that support it share the copied blocks between both
+/// files. The rows are written instead, if the file system can not copy them
+/// or the system has no copy_file_range
+static int save_job_copy_lines(save_job_t * job, save_job_copy_t const * copy, int fileDescriptor) {
+#ifdef COPY_FILE_RANGE_AVAILABLE
+    off_t offset = copy->offset;
+    size_t remaining = copy->length;
+    while (remaining) {
+        ssize_t copied = copy_file_range(job->sourceFileDescriptor, &offset, fileDescriptor, NULL, remaining, 0);
+        if (copied == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (remaining == copy->length && (errno == EXDEV || errno == EINVAL || errno == ENOSYS ||
+                                              errno == EOPNOTSUPP || errno == EBADF)) {
+                return save_job_write_lines(job, fileDescriptor, copy->line, copy->line + copy->lineCount);
+            }
+            return errno;
+        }
+        // The opened file was truncated by another program
+        if (copied == 0) {
+            return EIO;
+        }
+        job->bytesWritten += copied;
+        remaining -= copied;
+    }
+    return 0;
+#else
+    return save_job_write_lines(job, fileDescriptor, copy->line, copy->line + copy->lineCount);
+#endif
+}
+
+/// @brief Writes the rows of a save job to a temporary file and replaces the
+/// target with it
+/// @param argument The save job that is run
+/// @return NULL
+static void * save_job_run(void * argument) {
+    save_job_t * job = argument;
+    size_t pathLength = strlen(job->path);
+    char * temporaryPath = malloc(pathLength + sizeof(".XXXXXX"));
+    int error = ENOMEM;
+    if (temporaryPath) {
+        memcpy(temporaryPath, job->path, pathLength);
+        memcpy(&temporaryPath[pathLength], ".XXXXXX", sizeof(".XXXXXX"));
+        int fileDescriptor = mkstemp(temporaryPath);
+        if (fileDescriptor == -1) {
+            error = errno;
+        } else {
+            // The rows between the copied ranges are written from their character buffers
+            uint32_t line = 0;
+            error = 0;
+            for (uint32_t i = 0; !error && i <= job->copyCount; i++) {
+                uint32_t copyStart = i < job->copyCount ? job->copies[i].line : job->lineCount;
+                error = save_job_write_lines(job, fileDescriptor, line, copyStart);
+                if (!error && i < job->copyCount) {
+                    error = save_job_copy_lines(job, &job->copies[i], fileDescriptor);
+                    line = copyStart + job->copies[i].lineCount;
+                }
+            }
+            if (!error && fchmod(fileDescriptor, job->mode) == -1) {
+                error = errno;
+            }
+            if (!error && fsync(fileDescriptor) == -1) {
+                error = errno;
+            }
+            if (close(fileDescriptor) == -1 && !error) {
+                error = errno;
+            }
+            if (!error && rename(temporaryPath, job->path) == -1) {
+                error = errno;
+            }
+            if (error) {
+                unlink(temporaryPath);
+            }
+        }
+        free(temporaryPath);
+    }
+    pthread_mutex_lock(&job->lock);
+    job->error = error;
+    job->finished = true;
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+/// @brief Writes a range of the rows of a save job to a file, each of them
+/// followed by a newline
+/// @param job The save job that's rows are written
+/// @param fileDescriptor The file descriptor of the file
+/// @param line The index of the first row that is written
+/// @param end The index of the first row after the written rows
+/// @return 0 if all rows were written, otherwise the error that occured
+static int save_job_write_lines(save_job_t * job, int fileDescriptor, uint32_t line, uint32_t end) {
+    struct iovec batch[SAVE_JOB_BATCH_SIZE * 2];
+    char newline = '\n';
+    while (line < end) {
+        int count = 0;
+        size_t batchLength = 0;
+        for (; line < end && count < SAVE_JOB_BATCH_SIZE * 2; line++) {
+            batch[count++] = job->lines[line];
+            batch[count].iov_base = &newline;
+            batch[count++].iov_len = 1;
+            batchLength += job->lines[line].iov_len + 1;
+        }
+        // The remaining part of the batch is written again, if it was only written partially
+        struct iovec * remaining = batch;
+        while (batchLength) {
+            ssize_t written = writev(fileDescriptor, remaining, count);
+            if (written == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            job->bytesWritten += written;
+            batchLength -= written;
+            while (count && (size_t)written >= remaining->iov_len) {
+                written -= remaining->iov_len;
+                remaining++;
+                count--;
+            }
+            if (count) {
+                remaining->iov_base = (char *)remaining->iov_base + written;
+                remaining->iov_len -= written;
+            }
+        }
+    }
+    return 0;
+}
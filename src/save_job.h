@@ -0,0 +1,134 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file save_job.h
+ * @brief File containing the declaration of the save job and the corresponding
+ * functions.
+ * @details A save job writes the rows of a file on a background thread. The
+ * rows are written to a temporary file next to the target, that replaces the
+ * target once all rows were written and synchronized to the disk, so the
+ * target is never left in a partially written state. Ranges of rows that were
+ * not modified since the file was opened are copied from the opened file by
+ * the kernel, without passing through user space.
+ */
+
+#ifndef YATE_SAVE_JOB_H_
+#define YATE_SAVE_JOB_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/// Range of rows, that are copied from the opened file
+typedef struct {
+    /// The index of the first row of the range
+    uint32_t line;
+    /// The amount of rows of the range
+    uint32_t lineCount;
+    /// The offset of the first row in the opened file
+    off_t offset;
+    /// The amount of bytes of the rows, including their newlines
+    size_t length;
+} save_job_copy_t;
+
+/// Save job
+typedef struct {
+    /// The rows that are written, each of them is followed by a newline
+    struct iovec * lines;
+    /// The amount of rows that are written
+    uint32_t lineCount;
+    /// The ranges of rows that are copied from the opened file, ordered by
+    /// their first row
+    save_job_copy_t * copies;
+    /// The amount of ranges that are copied
+    uint32_t copyCount;
+    /// File descriptor of the opened file, that the ranges are copied from -
+    /// -1 if nothing is copied
+    int sourceFileDescriptor;
+    /// The path of the file that is replaced
+    char * path;
+    /// The permissions of the file that is written
+    mode_t mode;
+    /// Buffers that are freed once the rows were written
+    void ** deferredBuffers;
+    /// The amount of deferred buffers
+    uint32_t deferredCount;
+    /// The amount of deferred buffers that fit into the storage
+    uint32_t deferredCapacity;
+    /// The amount of bytes that were written
+    size_t bytesWritten;
+    /// The error that occured while saving or 0 if the file was saved
+    int error;
+    /// The thread that writes the rows
+    pthread_t thread;
+    /// Guards the finished flag
+    pthread_mutex_t lock;
+    /// Determines whether the thread was started and not joined yet
+    bool running;
+    /// Determines whether the thread is done writing
+    bool finished;
+} save_job_t;
+
+/// @brief Frees a buffer once the rows of a save job were written
+/// @param job The save job that might still use the buffer
+/// @param buffer The buffer that is freed
+/// @return true if the buffer was deferred, false if no memory was available
+bool save_job_defer_free(save_job_t * job, void * buffer);
+
+/// @brief Frees a save job that is not running
+/// @param job The save job that is freed
+/// @details The job can not be used anymore, until it is initialized again
+void save_job_free(save_job_t * job);
+
+/// @brief Initializes a save job
+/// @param job The save job that is initialized
+void save_job_init(save_job_t * job);
+
+/// @brief Determines whether a save job is done writing and joins its thread
+/// @param job The save job that is polled
+/// @return true if the save job was running and is done, false if not
+bool save_job_poll(save_job_t * job);
+
+/// @brief Frees the rows and the buffers of the last save of a save job that is
+/// not running, so the job can be started again
+/// @param job The save job that is reset
+void save_job_reset(save_job_t * job);
+
+/// @brief Starts writing rows on a background thread
+/// @param job The save job that is started
+/// @param path The path of the file that is written
+/// @param lines The rows that are written, the job takes ownership of the array
+/// @param lineCount The amount of rows that are written
+/// @param sourceFileDescriptor File descriptor of the opened file - -1 if
+/// nothing is copied
+/// @param copies The ranges of rows that are copied from the opened file
+/// instead of being written, the job takes ownership of the array
+/// @param copyCount The amount of ranges that are copied
+/// @return true if the thread was started, false if not
+/// @details The rows must not be modified or freed and the opened file must
+/// not be closed until the job is done. The rows of a range are written like
+/// the other rows, if the file system can not copy them
+bool save_job_start(save_job_t * job, char const * path, struct iovec * lines, uint32_t lineCount,
+                    int sourceFileDescriptor, save_job_copy_t * copies, uint32_t copyCount);
+
+/// @brief Waits until a save job is done writing and joins its thread
+/// @param job The save job that is waited for
+void save_job_wait(save_job_t * job);
+
+#endif
@@ -0,0 +1,190 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file search_index.c
+ * @brief File containing the implementation of the search index.
+ */
+
+#include "search_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Initial capacity of the matches of a search index
+#define SEARCH_INDEX_INITIAL_CAPACITY (64)
+
+static bool search_index_add_match(search_index_t *, uint32_t, uint32_t);
+static bool search_index_narrow(search_index_t *, row_buffer_t *, char const *, size_t);
+static bool search_index_scan_row(search_index_t *, uint32_t, char const *, size_t);
+static bool search_index_set_query(search_index_t *, char const *, size_t);
+
+search_match_t const * search_index_find_row(search_index_t const * index, uint32_t row, uint32_t * count) {
+    // Binary search for the first match in the row
+    uint32_t low = 0, high = index->count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (index->matches[middle].row < row) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    uint32_t end = low;
+    while (end < index->count && index->matches[end].row == row) {
+        end++;
+    }
+    *count = end - low;
+    return *count ? &index->matches[low] : NULL;
+}
+
+void search_index_free(search_index_t * index) {
+    free(index->query);
+    free(index->matches);
+    search_index_init(index);
+}
+
+void search_index_init(search_index_t * index) {
+    index->query = NULL;
+    index->queryLength = 0;
+    index->matches = NULL;
+    index->count = index->capacity = 0;
+}
+
+bool search_index_update(search_index_t * index, row_buffer_t * rows, char const * query, size_t length) {
+    bool updated;
+    if (index->queryLength && length >= index->queryLength && !memcmp(query, index->query, index->queryLength)) {
+        updated = search_index_narrow(index, rows, query, length);
+    } else {
+        index->count = 0;
+        updated = search_index_set_query(index, query, length);
+        uint32_t rowCount = row_buffer_count(rows);
+        for (uint32_t at = 0; updated && at < rowCount; at++) {
+            editor_row_t * row = row_buffer_at(rows, at);
+            updated = search_index_scan_row(index, at, row->chars, row->size);
+        }
+    }
+    if (!updated) {
+        // An incomplete index can not be narrowed, the next update searches the whole file again
+        search_index_free(index);
+    }
+    return updated;
+}
+
+/// @brief Appends a match to a search index
+/// @param index The search index where the match is appended
+/// @param row The index of the row that contains the match
+/// @param column The index of the first character of the match
+/// @return true if the match was appended, false if no memory was available
+static bool search_index_add_match(search_index_t * index, uint32_t row, uint32_t column) {
+    if (index->count == index->capacity) {
+        uint32_t newCapacity = index->capacity ? index->capacity * 2 : SEARCH_INDEX_INITIAL_CAPACITY;
+        search_match_t * matches = realloc(index->matches, sizeof(search_match_t) * newCapacity);
+        if (matches == NULL) {
+            return false;
+        }
+        index->matches = matches;
+        index->capacity = newCapacity;
+    }
+    index->matches[index->count].row = row;
+    index->matches[index->count].column = column;
+    index->count++;
+    return true;
+}
+
+/// @brief Removes the matches of a search index, that do not match an extended
+/// query
+/// @param index The search index where the matches are removed
+/// @param rows The rows that were searched
+/// @param query The extended query
+/// @param length The length of the extended query
+/// @return true if the index was updated, false if no memory was available
+static bool search_index_narrow(search_index_t * index, row_buffer_t * rows, char const * query, size_t length) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < index->count; i++) {
+        search_match_t match = index->matches[i];
+        editor_row_t * row = row_buffer_at(rows, match.row);
+        if (match.column + length <= row->size && !memcmp(&row->chars[match.column], query, length)) {
+            index->matches[kept++] = match;
+        }
+    }
+    index->count = kept;
+    return search_index_set_query(index, query, length);
+}
+
+/// @brief Appends all matches of the query in a single row to a search index
+/// @param index The search index where the matches are appended
+/// @param row The index of the row that is searched
+/// @param chars The underlying character buffer of the row
+/// @param size The amount of characters in the row
+/// @return true if all matches were appended, false if no memory was available
+/// @details Positions where the first and the last character of the query
+/// match are filtered 16 at a time, only those are compared with the whole
+/// query
+static bool search_index_scan_row(search_index_t * index, uint32_t row, char const * chars, size_t size) {
+    size_t length = index->queryLength;
+    if (length == 0 || size < length) {
+        return true;
+    }
+    char first = index->query[0];
+    char last = index->query[length - 1];
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i firstCharacters = _mm_set1_epi8(first);
+    __m128i lastCharacters = _mm_set1_epi8(last);
+    for (; i + length - 1 + 16 <= size; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128((__m128i const *)&chars[i]);
+        __m128i blockLast = _mm_loadu_si128((__m128i const *)&chars[i + length - 1]);
+        uint32_t candidates = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, firstCharacters), _mm_cmpeq_epi8(blockLast, lastCharacters)));
+        while (candidates) {
+            size_t column = i + __builtin_ctz(candidates);
+            if (!memcmp(&chars[column + 1], &index->query[1], length - 1) &&
+                !search_index_add_match(index, row, column)) {
+                return false;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; i + length <= size; i++) {
+        if (chars[i] == first && chars[i + length - 1] == last && !memcmp(&chars[i], index->query, length) &&
+            !search_index_add_match(index, row, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Stores a copy of the query of a search index
+/// @param index The search index where the query is stored
+/// @param query The query that is stored
+/// @param length The length of the query
+/// @return true if the query was stored, false if no memory was available
+static bool search_index_set_query(search_index_t * index, char const * query, size_t length) {
+    char * copy = realloc(index->query, length + 1);
+    if (copy == NULL) {
+        return false;
+    }
+    memcpy(copy, query, length);
+    copy[length] = '\0';
+    index->query = copy;
+    index->queryLength = length;
+    return true;
+}
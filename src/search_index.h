@@ -0,0 +1,83 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file search_index.h
+ * @brief File containing the declaration of the search index and the
+ * corresponding functions.
+ * @details The search index stores the position of every match of a query in
+ * the rows of the opened file. When the query is extended, only the stored
+ * matches are checked again instead of searching the whole file.
+ */
+
+#ifndef YATE_SEARCH_INDEX_H_
+#define YATE_SEARCH_INDEX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "row_buffer.h"
+
+/// Position of a single match
+typedef struct {
+    /// The index of the row that contains the match
+    uint32_t row;
+    /// The index of the first character of the match in the underlying
+    /// character buffer of the row
+    uint32_t column;
+} search_match_t;
+
+/// Search index
+typedef struct {
+    /// The query the matches were found for
+    char * query;
+    /// The length of the query
+    size_t queryLength;
+    /// The matches, ordered by their position in the file
+    search_match_t * matches;
+    /// The amount of matches
+    uint32_t count;
+    /// The amount of matches that fit into the storage
+    uint32_t capacity;
+} search_index_t;
+
+/// @brief Gets the matches that are located in a single row
+/// @param index The search index that contains the matches
+/// @param row The index of the row
+/// @param count Is set to the amount of matches in the row
+/// @return Pointer to the first match of the row or NULL if the row contains
+/// no matches
+search_match_t const * search_index_find_row(search_index_t const * index, uint32_t row, uint32_t * count);
+
+/// @brief Frees a search index
+/// @param index The search index that is freed
+void search_index_free(search_index_t * index);
+
+/// @brief Initializes a search index
+/// @param index The search index that is initialized
+void search_index_init(search_index_t * index);
+
+/// @brief Updates a search index, so it contains the matches of a query
+/// @param index The search index that is updated
+/// @param rows The rows that are searched
+/// @param query The query that is searched for
+/// @param length The length of the query
+/// @return true if the index was updated, false if no memory was available
+/// @details If the query extends the previous query, only the previous matches
+/// are checked. The rows must not have been modified since the last update
+bool search_index_update(search_index_t * index, row_buffer_t * rows, char const * query, size_t length);
+
+#endif
@@ -21,6 +21,16 @@
 
 #include "syntax.h"
 
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void syntax_compile_keyword_table(editor_syntax_t *);
+static uint32_t syntax_hash_keyword(char const *, size_t);
+static uint32_t syntax_map_to_16_colors(int32_t);
+static uint32_t syntax_map_to_256_colors(int32_t);
+
 char * CFileExtensions[] = {".c", ".h", NULL};
 
 char * CKeywords[] = {"switch",  "if",     "while",   "for",       "break",   "continue", "return", "else",
@@ -45,7 +55,7 @@ char * CPPKeywords[] = {"switch",
                         "class",
                         "case",
                         "private",
-                        "public"
+                        "public",
                         "int|",
                         "long|",
                         "double|",
@@ -64,7 +74,7 @@ char * Chip8FileExtensions[] = {".cp8", NULL};
 
 char * Chip8Keywords[] = {"NOP",  "EXT",  "CLS",  "TGS",  "RET", "JMP",  "CAL",  "SKE",  "SKNE", "MOV",
                           "MOVO", "MOVA", "MOVX", "MOVS", "ADD", "SUB",  "STLS", "MOVS", "STMS", "JRB",
-                          "RND",  "DSP",  "PRT",  "SKP",  "STK", "STBC", "STMR", "FMR"};
+                          "RND",  "DSP",  "PRT",  "SKP",  "STK", "STBC", "STMR", "FMR",  NULL};
 
 char * GoFileExtensions[] = {".go", NULL};
 
@@ -106,18 +116,115 @@ char * PythonKeywords[] = {
     "str|", "tuple|", "True|", "type|", "unicode|", "xrange|", NULL};
 
 editor_syntax_t HighLightDataBase[] = {
-    {"C", CFileExtensions, CKeywords, "//", "/*", "*/", SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
-    {"C++", CPPFileExtensions, CPPKeywords, "//", "/*", "*/", SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
+    {"C", CFileExtensions, CKeywords, "//", "/*", "*/",
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
+    {"C++", CPPFileExtensions, CPPKeywords, "//", "/*", "*/",
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
     {"Cellox", CelloxFileExtensions, CelloxKeywords, "//", "/*", "*/",
-     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
-    {"CHIP-8", Chip8FileExtensions, Chip8Keywords, "#", "", "", SYNTAX_HIGHLIGHT_NUMBERS},
-    {"Go", GoFileExtensions, GoKeywords, "#", "", "", SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
+    {"CHIP-8", Chip8FileExtensions, Chip8Keywords, "#", "", "", SYNTAX_HIGHLIGHT_NUMBERS, {NULL, 0, 0}},
+    {"Go", GoFileExtensions, GoKeywords, "#", "", "",
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
     {"JBASIC", JBASICFileExtensions, JBASICKeywords, "REM", "", "",
-     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
-    {"Lua", LuaFileExtensions, LuaKeywords, "--", "--[[", "--]]", SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
-    {"Python", PythonFileExtensions, PythonKeywords, "//", "", "", SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS},
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
+    {"Lua", LuaFileExtensions, LuaKeywords, "--", "--[[", "--]]",
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
+    {"Python", PythonFileExtensions, PythonKeywords, "//", "", "",
+     SYNTAX_HIGHLIGHT_NUMBERS | SYNTAX_HIGHLIGHT_STRINGS, {NULL, 0, 0}},
 };
 
+/// The escape sequences that select the colors of the highlighting groups
+static syntax_color_sequence_t colorSequences[SYNTAX_HIGHLIGHT_GROUP_COUNT];
+
+void syntax_compile_color_sequences(syntax_color_mode_t mode) {
+    if (mode == SYNTAX_COLOR_MODE_AUTOMATIC) {
+        mode = syntax_detect_color_mode();
+    }
+    for (int32_t group = 0; group < SYNTAX_HIGHLIGHT_GROUP_COUNT; group++) {
+        syntax_color_sequence_t * sequence = &colorSequences[group];
+        sequence->persistent = false;
+        if (group == HIGHTLIGHT_NORMAL) {
+            // Reset back- and foreground color to default, in monochrome mode all attributes are reset
+            sequence->length = mode == SYNTAX_COLOR_MODE_MONOCHROME ? 3 : 8;
+            memcpy(sequence->bytes, mode == SYNTAX_COLOR_MODE_MONOCHROME ? "\x1b[m" : "\x1b[39;49m", sequence->length);
+            continue;
+        }
+        // The most significant byte determines whether the fore- or background is colored, the three least
+        // significant bytes are the rgb values
+        int32_t color = syntax_convert_to_color(group);
+        bool background = (color & 0xff000000) != 0;
+        // A colored background is not replaced by the foreground color of the next group
+        sequence->persistent = background;
+        switch (mode) {
+        case SYNTAX_COLOR_MODE_MONOCHROME:
+            {
+                // Keywords are bold, strings are underlined and matches are reversed
+                int attribute = 0;
+                if (group == HIGHLIGHT_MATCH) {
+                    attribute = 7;
+                } else if (group == HIGHLIGHT_STRING) {
+                    attribute = 4;
+                } else if (group >= HIGHLIGHT_KEYWORDS_FIRST_GROUP && group <= HIGHLIGHT_KEYWORDS_FOURTH_GROUP) {
+                    attribute = 1;
+                }
+                // Groups without an attribute keep the default appearance
+                sequence->persistent = attribute != 0;
+                sequence->length =
+                    attribute ? snprintf(sequence->bytes, sizeof(sequence->bytes), "\x1b[%dm", attribute) : 0;
+            }
+            break;
+        case SYNTAX_COLOR_MODE_16:
+            {
+                // The bright colors have separate codes
+                uint32_t index = syntax_map_to_16_colors(color);
+                uint32_t code = (background ? 40 : 30) + (index & 7) + (index & 8 ? 60 : 0);
+                sequence->length = snprintf(sequence->bytes, sizeof(sequence->bytes), "\x1b[%um", code);
+            }
+            break;
+        case SYNTAX_COLOR_MODE_256:
+            sequence->length = snprintf(sequence->bytes, sizeof(sequence->bytes), "\x1b[%d;5;%um",
+                                        background ? 48 : 38, syntax_map_to_256_colors(color));
+            break;
+        default:
+            sequence->length = snprintf(sequence->bytes, sizeof(sequence->bytes),
+                                        background ? "\x1b[48;2;%d;%d;%dm" : "\x1b[38;2;%d;%d;%dm",
+                                        (color & 0x00ff0000) >> 16, (color & 0x0000ff00) >> 8, color & 0x000000ff);
+            break;
+        }
+    }
+}
+
+void syntax_compile_keyword_tables() {
+    size_t languageCount = syntax_get_language_count();
+    for (size_t i = 0; i < languageCount; i++) {
+        if (!HighLightDataBase[i].keywordTable.slots) {
+            syntax_compile_keyword_table(&HighLightDataBase[i]);
+        }
+    }
+}
+
+syntax_color_mode_t syntax_detect_color_mode() {
+    char const * colorTerm = getenv("COLORTERM");
+    if (colorTerm && (!strcmp(colorTerm, "truecolor") || !strcmp(colorTerm, "24bit"))) {
+        return SYNTAX_COLOR_MODE_TRUECOLOR;
+    }
+    char const * term = getenv("TERM");
+    if (!term || !strcmp(term, "dumb") || !strncmp(term, "vt", 2)) {
+        return SYNTAX_COLOR_MODE_MONOCHROME;
+    }
+    if (strstr(term, "direct")) {
+        return SYNTAX_COLOR_MODE_TRUECOLOR;
+    }
+    if (strstr(term, "256color")) {
+        return SYNTAX_COLOR_MODE_256;
+    }
+    return SYNTAX_COLOR_MODE_16;
+}
+
+syntax_color_sequence_t const * syntax_get_color_sequence(editorHighlight highlightGroup) {
+    return &colorSequences[highlightGroup];
+}
+
 size_t syntax_get_language_count() {
     return sizeof(HighLightDataBase) / sizeof(editor_syntax_t);
 }
@@ -145,4 +252,134 @@ int32_t syntax_convert_to_color(editorHighlight highlightGroup) {
     default:
         return (255 << 16) | (255 << 8) | 255;
     }
-}
\ No newline at end of file
+}
+
+editorHighlight syntax_lookup_keyword(editor_syntax_t const * syntax, char const * word, size_t length) {
+    syntax_keyword_table_t const * table = &syntax->keywordTable;
+    if (!table->slots || !(table->lengthMask & (1ULL << (length < 63 ? length : 63)))) {
+        return HIGHTLIGHT_NORMAL;
+    }
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t slot = syntax_hash_keyword(word, length) & mask; table->slots[slot].characters;
+         slot = (slot + 1) & mask) {
+        if (table->slots[slot].length == length && !memcmp(table->slots[slot].characters, word, length)) {
+            return table->slots[slot].highlightGroup;
+        }
+    }
+    return HIGHTLIGHT_NORMAL;
+}
+
+/// @brief Compiles the keywords of a single language to a hash table
+/// @param syntax The language whose keywords are compiled
+/// @details The trailing character of a keyword determines it's group ('|' for
+/// the second, '&' for the third and '~' for the fourth group). If a keyword
+/// occurs twice, the first occurence is used.
+static void syntax_compile_keyword_table(editor_syntax_t * syntax) {
+    size_t keywordCount = 0;
+    while (syntax->keywords[keywordCount]) {
+        keywordCount++;
+    }
+    // At most half of the slots are used, so probing sequences stay short
+    uint32_t capacity = 16;
+    while (capacity < keywordCount * 2) {
+        capacity *= 2;
+    }
+    syntax_keyword_t * slots = calloc(capacity, sizeof(syntax_keyword_t));
+    if (!slots) {
+        return;
+    }
+    syntax->keywordTable.lengthMask = 0;
+    for (size_t i = 0; i < keywordCount; i++) {
+        char const * keyword = syntax->keywords[i];
+        size_t length = strlen(keyword);
+        editorHighlight highlightGroup = HIGHLIGHT_KEYWORDS_FIRST_GROUP;
+        switch (length ? keyword[length - 1] : '\0') {
+        case '|':
+            highlightGroup = HIGHLIGHT_KEYWORDS_SECOND_GROUP;
+            length--;
+            break;
+        case '&':
+            highlightGroup = HIGHLIGHT_KEYWORDS_THIRD_GROUP;
+            length--;
+            break;
+        case '~':
+            highlightGroup = HIGHLIGHT_KEYWORDS_FOURTH_GROUP;
+            length--;
+            break;
+        }
+        if (!length) {
+            continue;
+        }
+        uint32_t slot = syntax_hash_keyword(keyword, length) & (capacity - 1);
+        bool duplicate = false;
+        while (slots[slot].characters && !duplicate) {
+            duplicate = slots[slot].length == length && !memcmp(slots[slot].characters, keyword, length);
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (duplicate) {
+            continue;
+        }
+        slots[slot].characters = keyword;
+        slots[slot].length = length;
+        slots[slot].highlightGroup = highlightGroup;
+        syntax->keywordTable.lengthMask |= 1ULL << (length < 63 ? length : 63);
+    }
+    syntax->keywordTable.slots = slots;
+    syntax->keywordTable.capacity = capacity;
+}
+
+/// @brief Hashes a keyword using FNV-1a
+/// @param keyword The characters of the keyword
+/// @param length The length of the keyword
+/// @return The hash of the keyword
+static uint32_t syntax_hash_keyword(char const * keyword, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)keyword[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/// @brief Maps a rgb color to the ANSI palette
+/// @param color The rgb color
+/// @return The index of the color in the palette, the bright colors start at 8
+/// @details Every channel, that reaches 60% of the strongest one, is part of
+/// the color. Colors with little saturation are mapped to the shades of gray
+static uint32_t syntax_map_to_16_colors(int32_t color) {
+    uint32_t red = (color & 0x00ff0000) >> 16, green = (color & 0x0000ff00) >> 8, blue = color & 0x000000ff;
+    uint32_t maximum = red > green ? (red > blue ? red : blue) : (green > blue ? green : blue);
+    uint32_t minimum = red < green ? (red < blue ? red : blue) : (green < blue ? green : blue);
+    if (maximum - minimum < 64) {
+        // Black, gray, light gray and white
+        return maximum < 48 ? 0 : maximum < 170 ? 8 : maximum < 240 ? 7 : 15;
+    }
+    uint32_t threshold = maximum * 6 / 10;
+    uint32_t index = (red >= threshold ? 1 : 0) | (green >= threshold ? 2 : 0) | (blue >= threshold ? 4 : 0);
+    return maximum > 230 ? index + 8 : index;
+}
+
+/// @brief Maps a rgb color to the xterm palette
+/// @param color The rgb color
+/// @return The index of the nearest color of the 6x6x6 color cube or of the
+/// gray ramp
+static uint32_t syntax_map_to_256_colors(int32_t color) {
+    int32_t channels[3] = {(color & 0x00ff0000) >> 16, (color & 0x0000ff00) >> 8, color & 0x000000ff};
+    // The levels of the color cube are 0, 95, 135, 175, 215 and 255
+    int32_t cubeIndex = 16, cubeDistance = 0, graySum = 0;
+    for (int i = 0; i < 3; i++) {
+        int32_t level = channels[i] < 48 ? 0 : channels[i] < 115 ? 1 : (channels[i] - 35) / 40;
+        int32_t value = level ? 55 + level * 40 : 0;
+        cubeIndex += level * (i == 0 ? 36 : i == 1 ? 6 : 1);
+        cubeDistance += (channels[i] - value) * (channels[i] - value);
+        graySum += channels[i];
+    }
+    // The gray ramp ranges from 8 to 238 in steps of 10
+    int32_t grayIndex = (graySum / 3 - 3) / 10;
+    grayIndex = grayIndex < 0 ? 0 : grayIndex > 23 ? 23 : grayIndex;
+    int32_t grayValue = 8 + grayIndex * 10, grayDistance = 0;
+    for (int i = 0; i < 3; i++) {
+        grayDistance += (channels[i] - grayValue) * (channels[i] - grayValue);
+    }
+    return (uint32_t)(grayDistance < cubeDistance ? 232 + grayIndex : cubeIndex);
+}
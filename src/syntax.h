@@ -28,6 +28,7 @@
 /// Syntax highlighting for strings
 #define SYNTAX_HIGHLIGHT_STRINGS (1 << 1)
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -45,6 +46,54 @@ typedef enum {
     HIGHLIGHT_MATCH
 } editorHighlight;
 
+/// The amount of syntax highlighting groups
+#define SYNTAX_HIGHLIGHT_GROUP_COUNT (HIGHLIGHT_MATCH + 1)
+
+/// The colors a terminal supports
+typedef enum {
+    /// The color mode is detected from the environment
+    SYNTAX_COLOR_MODE_AUTOMATIC = 0,
+    /// No colors - the highlighting groups are bold, underlined or reversed
+    SYNTAX_COLOR_MODE_MONOCHROME,
+    /// The 16 colors of the ANSI palette
+    SYNTAX_COLOR_MODE_16,
+    /// The 256 colors of the xterm palette
+    SYNTAX_COLOR_MODE_256,
+    /// 24 bit rgb colors
+    SYNTAX_COLOR_MODE_TRUECOLOR
+} syntax_color_mode_t;
+
+/// Escape sequence that selects the color of a syntax highlighting group
+typedef struct {
+    /// The bytes of the escape sequence
+    char bytes[24];
+    /// The amount of bytes of the escape sequence
+    uint32_t length;
+    /// Determines whether the sequence sets an attribute, that is not replaced
+    /// by the sequence of another group and has to be reset first
+    bool persistent;
+} syntax_color_sequence_t;
+
+/// A keyword of a language, that was preprocessed for the keyword lookup
+typedef struct {
+    /// The characters of the keyword, without the group marker
+    char const * characters;
+    /// The length of the keyword, without the group marker
+    uint32_t length;
+    /// The highlighting group the keyword belongs to
+    editorHighlight highlightGroup;
+} syntax_keyword_t;
+
+/// Hash table of the keywords of a language
+typedef struct {
+    /// The slots of the hash table, empty slots have no characters
+    syntax_keyword_t * slots;
+    /// The amount of slots, always a power of two
+    uint32_t capacity;
+    /// Bit n is set if there is a keyword of length n (or 63 for longer ones)
+    uint64_t lengthMask;
+} syntax_keyword_table_t;
+
 /// Models a syntax for a programming language
 typedef struct {
     /// The name of the type of file e.g. xml, Cellox
@@ -61,11 +110,37 @@ typedef struct {
     char * multiline_comment_end;
     /// General Language flags (e.g higlight all strings / numbers)
     uint32_t flags;
+    /// The keywords of the language compiled to a hash table
+    syntax_keyword_table_t keywordTable;
 } editor_syntax_t;
 
 /// Syntax Highlighting database
 extern editor_syntax_t HighLightDataBase[];
 
+/// @brief Formats the escape sequences that select the colors of the syntax
+/// highlighting groups
+/// @param mode The colors the terminal supports, the shortest sequences that
+/// the terminal supports are used
+/// @details The sequence of the normal group resets the colors to the default
+void syntax_compile_color_sequences(syntax_color_mode_t mode);
+
+/// @brief Compiles the keywords of every language in the syntax highlighting
+/// database to a hash table
+/// @details Languages that were already compiled are skipped
+void syntax_compile_keyword_tables();
+
+/// @brief Detects the colors the terminal supports from the COLORTERM and the
+/// TERM environment variables
+/// @return The detected color mode
+syntax_color_mode_t syntax_detect_color_mode();
+
+/// @brief Gets the escape sequence that selects the color of a syntax
+/// highlighting group
+/// @param highlightGroup The highlight group
+/// @return The escape sequence, that was formatted by
+/// syntax_compile_color_sequences
+syntax_color_sequence_t const * syntax_get_color_sequence(editorHighlight highlightGroup);
+
 /// @brief Gets the amount of languages for which syntax highlighting is
 /// provided
 /// @return The number of languages with syntax highlighting
@@ -79,4 +154,12 @@ size_t syntax_get_language_count();
 /// the highlighting applies to the fore- or the background.
 int32_t syntax_convert_to_color(editorHighlight highlightGroup);
 
+/// @brief Looks up a word in the keywords of a language
+/// @param syntax The language whose keywords are searched
+/// @param word The characters of the word
+/// @param length The length of the word
+/// @return The highlighting group of the keyword or HIGHTLIGHT_NORMAL if the
+/// word is not a keyword
+editorHighlight syntax_lookup_keyword(editor_syntax_t const * syntax, char const * word, size_t length);
+
 #endif
\ No newline at end of file
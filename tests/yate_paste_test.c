@@ -0,0 +1,109 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file yate_paste_test.c
+ * @brief File containing the tests of pasting text into the terminal.
+ * @details editor.c is included, so the rows can be inspected directly. The
+ * pasted text is written to the pipe the editor reads its input from, with and
+ * without the mark at the end of the text.
+ */
+
+// Included first, so the feature test macros at its top apply to all headers
+#include "editor.c"
+
+/// A pasted text
+typedef struct {
+    /// The name of the test
+    char const * name;
+    /// The bytes that are written to the input of the editor
+    char const * input;
+    /// Determines whether the input is closed after the bytes were written
+    bool closed;
+    /// The rows after the text was pasted, separated by newlines
+    char const * expected;
+} paste_test_t;
+
+static uint32_t paste_test_run(paste_test_t const *);
+
+/// @brief Main entry point of the paste tests
+/// @return 0 if all tests passed, 1 if not
+int main() {
+    int sink = open("/dev/null", O_WRONLY);
+    configuration_reader_result_t * config = configuration_reader_default_configuration();
+    if (sink == -1 || !config) {
+        perror("paste_test");
+        return 1;
+    }
+    editor_initialize_with_terminal(config, -1, sink, 50, 160);
+
+    paste_test_t const tests[] = {
+        {"marked", "\x1b[200~first\nsecond\x1b[201~", false, "first\nsecond"},
+        {"escape sequence in text", "\x1b[200~a\x1b[20x\x1b[201~", false, "a\x1b[20x"},
+        {"end missing", "\x1b[200~first\nsecond", false, "first\nsecond"},
+        {"end cut off", "\x1b[200~first\nsecond\x1b[20", false, "first\nsecond"},
+        {"input closed", "\x1b[200~first\nsecond", true, "first\nsecond"},
+    };
+    uint32_t failures = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        failures += paste_test_run(&tests[i]);
+    }
+    if (failures) {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+    printf("passed\n");
+    return 0;
+}
+
+/// @brief Pastes a text into an empty buffer and compares the rows with the
+/// expected rows
+/// @param test The pasted text
+/// @return 1 if the rows differ or the input could not be created, 0 if not
+static uint32_t paste_test_run(paste_test_t const * test) {
+    int descriptors[2];
+    if (pipe(descriptors) == -1 || fcntl(descriptors[0], F_SETFL, O_NONBLOCK) == -1) {
+        perror("paste_test");
+        return 1;
+    }
+    editor_free_rows();
+    editorConfig.current->cursorCurrentX = editorConfig.current->cursorCurrentY = 0;
+    editorConfig.inputFileDescriptor = descriptors[0];
+    editorConfig.inputStart = editorConfig.inputEnd = 0;
+    write(descriptors[1], test->input, strlen(test->input));
+    if (test->closed) {
+        close(descriptors[1]);
+    }
+    editor_process_keypress();
+    append_buffer_t rows;
+    append_buffer_init(&rows);
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows; at++) {
+        editor_row_t * row = editor_get_row(at);
+        if (at) {
+            append_buffer_append_string(&rows, "\n", 1);
+        }
+        append_buffer_append_string(&rows, row->chars, row->size);
+    }
+    bool passed = rows.length == strlen(test->expected) && !memcmp(rows.buffer, test->expected, rows.length);
+    if (!passed) {
+        printf("FAILED %s: %.*s\n", test->name, (int)rows.length, rows.buffer);
+    }
+    append_buffer_free(&rows);
+    close(descriptors[0]);
+    if (!test->closed) {
+        close(descriptors[1]);
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file yate_row_patch_test.c
+ * @brief File containing the tests of the patching of rows after a single
+ * character was inserted or deleted.
+ * @details editor.c is included, so its static functions can be called
+ * directly. Characters are inserted and deleted at random in rows, that
+ * contain tabs and the comment delimiters of every language. After every
+ * modification, the patched render buffer, syntax highlighting, multiline
+ * comment states and column checkpoints of the rows are compared with rows
+ * that are rendered and highlighted from scratch. The test is built with a
+ * small margin around the modification as well, so the window of the patch
+ * is crossed.
+ */
+
+// Included first, so the feature test macros at its top apply to all headers
+#include "editor.c"
+
+/// The amount of rows that are modified
+#define ROW_PATCH_TEST_ROW_COUNT (6)
+
+/// The amount of times the rows are filled again for each language - rows
+/// that are longer than a large margin are compared less often, so the test
+/// stays quick
+#define ROW_PATCH_TEST_ROUNDS (PATCH_HIGHLIGHT_MARGIN > COLUMN_MAP_INTERVAL ? 1 : 8)
+
+/// The amount of modifications of the rows in every round
+#define ROW_PATCH_TEST_MODIFICATIONS (PATCH_HIGHLIGHT_MARGIN > COLUMN_MAP_INTERVAL ? 100 : 400)
+
+/// The maximum amount of characters of the rows, so they are longer than the
+/// margin of the patch and get a column map
+#define ROW_PATCH_TEST_MAXIMUM_ROW_SIZE (2 * PATCH_HIGHLIGHT_MARGIN + 2 * COLUMN_MAP_INTERVAL)
+
+/// State of the pseudo random numbers, so every run modifies the same rows
+static uint64_t randomState = 0x9e3779b97f4a7c15;
+
+static bool row_patch_test_compare(char const *, uint32_t);
+static void row_patch_test_fill_rows(char const * const *, size_t);
+static uint32_t row_patch_test_language(editor_syntax_t *);
+static uint32_t row_patch_test_random(uint32_t);
+
+/// @brief Main entry point of the row patch tests
+/// @return 0 if all tests passed, 1 if not
+int main() {
+    int descriptors[2];
+    int sink = open("/dev/null", O_WRONLY);
+    configuration_reader_result_t * config = configuration_reader_default_configuration();
+    if (pipe(descriptors) == -1 || fcntl(descriptors[0], F_SETFL, O_NONBLOCK) == -1 || sink == -1 || !config) {
+        perror("row_patch_test");
+        return 1;
+    }
+    editor_initialize_with_terminal(config, descriptors[0], sink, 50, 160);
+
+    uint32_t failures = row_patch_test_language(NULL);
+    for (size_t i = 0; i < syntax_get_language_count(); i++) {
+        failures += row_patch_test_language(&HighLightDataBase[i]);
+    }
+    if (failures) {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+    printf("passed with a margin of %d\n", PATCH_HIGHLIGHT_MARGIN);
+    return 0;
+}
+
+/// @brief Compares the rows with rows that are rendered and highlighted from
+/// scratch
+/// @param language The name of the language of the rows
+/// @param modification The number of the modification that was made last
+/// @return true if the rows are equal, false if not
+static bool row_patch_test_compare(char const * language, uint32_t modification) {
+    editor_row_t scratch = {0};
+    bool passed = true;
+    bool insideComment = false;
+    for (uint32_t at = 0; at < editorConfig.current->numberOfRows && passed; at++) {
+        editor_row_t * row = editor_get_row(at);
+        scratch.chars = row->chars;
+        scratch.size = row->size;
+        editor_render_row(&scratch);
+        unsigned char * expected = malloc(scratch.renderSize + 1);
+        unsigned char * actual = malloc(row->renderSize + 1);
+        if (expected == NULL || actual == NULL) {
+            editor_die("malloc");
+        }
+        insideComment = editor_highlight_columns(&scratch, expected, insideComment);
+        if (row->render && at < editorConfig.current->syntaxValidRows) {
+            highlight_runs_decode_range(row->highLightRuns, row->highLightRunCount, &row->highLightCursor, 0,
+                                        row->renderSize, actual);
+            if (row->renderSize != scratch.renderSize || memcmp(row->render, scratch.render, row->renderSize)) {
+                printf("FAILED %s, modification %u: render buffer of row %u\n", language, modification, at);
+                passed = false;
+            } else if (memcmp(actual, expected, row->renderSize)) {
+                printf("FAILED %s, modification %u: highlighting of row %u\n", language, modification, at);
+                passed = false;
+            } else if (row->hightLightOpenComment != insideComment) {
+                printf("FAILED %s, modification %u: multiline comment state of row %u\n", language, modification, at);
+                passed = false;
+            }
+        }
+        for (uint32_t i = 0; passed && row->columnMap && i < row->columnMap->count; i++) {
+            column_map_position_t checkpoint = row->columnMap->checkpoints[i];
+            column_map_position_t position = column_map_find_character(NULL, row->chars, row->size,
+                                                                       editorConfig.config->tabStopSize,
+                                                                       checkpoint.character);
+            if (position.render != checkpoint.render || position.column != checkpoint.column) {
+                printf("FAILED %s, modification %u: column checkpoint %u of row %u\n", language, modification, i, at);
+                passed = false;
+            }
+        }
+        free(expected);
+        free(actual);
+    }
+    if (!scratch.renderAliased) {
+        free(scratch.render);
+    }
+    return passed;
+}
+
+/// @brief Replaces the rows of the editor with random rows, that consist of
+/// the specified pieces
+/// @param pieces The pieces the rows consist of
+/// @param pieceCount The amount of pieces
+static void row_patch_test_fill_rows(char const * const * pieces, size_t pieceCount) {
+    editor_free_rows();
+    char * line = malloc(ROW_PATCH_TEST_MAXIMUM_ROW_SIZE + 64);
+    if (line == NULL) {
+        editor_die("malloc");
+    }
+    for (uint32_t at = 0; at < ROW_PATCH_TEST_ROW_COUNT; at++) {
+        uint32_t size = row_patch_test_random(ROW_PATCH_TEST_MAXIMUM_ROW_SIZE);
+        uint32_t length = 0;
+        while (length < size) {
+            char const * piece = pieces[row_patch_test_random(pieceCount)];
+            memcpy(&line[length], piece, strlen(piece));
+            length += strlen(piece);
+        }
+        editor_insert_row(at, line, length);
+    }
+    free(line);
+    editorConfig.current->cursorCurrentX = editorConfig.current->cursorCurrentY = 0;
+    editorConfig.current->rowOffset = 0;
+    for (uint32_t at = 0; at < ROW_PATCH_TEST_ROW_COUNT; at++) {
+        editor_prepare_row(at);
+    }
+}
+
+/// @brief Inserts and deletes characters at random in rows of a language
+/// @param syntax The language of the rows, NULL if the rows are not
+/// highlighted
+/// @return The amount of rounds where the rows differed
+static uint32_t row_patch_test_language(editor_syntax_t * syntax) {
+    char const * language = syntax ? syntax->filetype : "no language";
+    editorConfig.current->syntax = syntax;
+    if (syntax) {
+        lexer_compile(&editorConfig.current->lexer, syntax);
+    }
+    // Plain characters, separators, strings, numbers, tabs, a multibyte character, a keyword and the comment
+    // delimiters
+    char const * pieces[24] = {"a", "bc", " ", "  ", "\t", "\"", "'", "(", ")", ";", "1", "2.5", "x", "\xc3\xa9"};
+    size_t pieceCount = 14;
+    if (syntax) {
+        char const * delimiters[] = {syntax->keywords ? syntax->keywords[0] : NULL, syntax->singleline_comment_start,
+                                     syntax->multiline_comment_start, syntax->multiline_comment_end};
+        for (size_t i = 0; i < sizeof(delimiters) / sizeof(delimiters[0]); i++) {
+            if (delimiters[i]) {
+                // The delimiters are more frequent, so comments are opened and closed often
+                pieces[pieceCount++] = delimiters[i];
+                pieces[pieceCount++] = delimiters[i];
+            }
+        }
+    }
+    uint32_t failures = 0;
+    for (uint32_t round = 0; round < ROW_PATCH_TEST_ROUNDS; round++) {
+        row_patch_test_fill_rows(pieces, pieceCount);
+        for (uint32_t modification = 0; modification < ROW_PATCH_TEST_MODIFICATIONS; modification++) {
+            uint32_t at = row_patch_test_random(ROW_PATCH_TEST_ROW_COUNT);
+            editor_row_t * row = editor_get_row(at);
+            if (row_patch_test_random(4) == 0) {
+                // The checkpoints of an existing column map are moved by the patch
+                editor_row_cx_to_rx(row, row->size);
+            }
+            // Multibyte characters are inserted and deleted as a whole, so the row stays valid UTF-8
+            uint32_t position = row_patch_test_random(row->size + 1);
+            while (position > 0 && (row->chars[position] & 0xc0) == 0x80) {
+                position--;
+            }
+            if (position < row->size && row_patch_test_random(2)) {
+                do {
+                    editor_row_delete_character(at, position);
+                } while (position < row->size && (row->chars[position] & 0xc0) == 0x80);
+            } else {
+                char const * piece = pieces[row_patch_test_random(pieceCount)];
+                for (size_t i = 0; piece[i]; i++) {
+                    editor_row_insert_character(at, position + (uint32_t)i, (unsigned char)piece[i]);
+                }
+            }
+            if (!row_patch_test_compare(language, modification)) {
+                failures++;
+                break;
+            }
+        }
+    }
+    return failures;
+}
+
+/// @brief Determines a pseudo random number
+/// @param bound The number is less than the bound
+/// @return The pseudo random number
+static uint32_t row_patch_test_random(uint32_t bound) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return (uint32_t)(randomState % bound);
+}
@@ -0,0 +1,150 @@
+/****************************************************************************
+ * Copyright (C) 2022 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of Yate.                                               *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file yate_syntax_scan_test.c
+ * @brief File containing the tests of the parallel scan of the multiline
+ * comment state.
+ * @details editor.c is included, so its static functions can be called
+ * directly. The states a chunk determines speculatively for both states at its
+ * start are compared with a sequential scan of the rows.
+ */
+
+// Included first, so the feature test macros at its top apply to all headers
+#include "editor.c"
+
+/// The amount of times the test rows are repeated, so the rows are scanned by
+/// several threads
+#define SYNTAX_SCAN_TEST_REPETITIONS (4 * PARALLEL_SCAN_MINIMUM_CHUNK_SIZE)
+
+/// C rows with all the transitions of the multiline comment state - the
+/// string followed by a comment swaps both states, outside of a comment the
+/// comment is opened and inside of it the comment is closed and the rest of
+/// the row is a string
+static char const * const testRows[] = {
+    "int x;", "\"*/\" /*", "int y;", "*/ int z;", "/* open", "still inside", "\"*/\" /*", "close */",
+    "\"*/\" /*", "\"*/\" /*", "int w; /* note */",
+};
+
+/// The amount of test rows
+#define SYNTAX_SCAN_TEST_ROW_COUNT (sizeof(testRows) / sizeof(testRows[0]))
+
+static void syntax_scan_test_fill_rows(uint32_t);
+static uint32_t syntax_scan_test_parallel();
+static bool syntax_scan_test_sequential(uint32_t, bool);
+static uint32_t syntax_scan_test_speculative();
+
+/// @brief Main entry point of the syntax scan tests
+/// @return 0 if all tests passed, 1 if not
+int main() {
+    int descriptors[2];
+    int sink = open("/dev/null", O_WRONLY);
+    configuration_reader_result_t * config = configuration_reader_default_configuration();
+    if (pipe(descriptors) == -1 || fcntl(descriptors[0], F_SETFL, O_NONBLOCK) == -1 || sink == -1 || !config) {
+        perror("syntax_scan_test");
+        return 1;
+    }
+    editor_initialize_with_terminal(config, descriptors[0], sink, 50, 160);
+    editorConfig.current->syntax = &HighLightDataBase[0];
+    lexer_compile(&editorConfig.current->lexer, editorConfig.current->syntax);
+
+    uint32_t failures = syntax_scan_test_speculative() + syntax_scan_test_parallel();
+    if (failures) {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+    printf("passed\n");
+    return 0;
+}
+
+/// @brief Replaces the rows of the editor with the test rows
+/// @param repetitions The amount of times the test rows are repeated
+static void syntax_scan_test_fill_rows(uint32_t repetitions) {
+    editor_free_rows();
+    for (uint32_t at = 0; at < repetitions * SYNTAX_SCAN_TEST_ROW_COUNT; at++) {
+        char const * line = testRows[at % SYNTAX_SCAN_TEST_ROW_COUNT];
+        editor_insert_row(at, (char *)line, strlen(line));
+    }
+}
+
+/// @brief Scans a large file in parallel and compares the states of the rows
+/// with a sequential scan
+/// @return The amount of rows whose state differs
+static uint32_t syntax_scan_test_parallel() {
+    syntax_scan_test_fill_rows(SYNTAX_SCAN_TEST_REPETITIONS);
+    uint32_t rowCount = editorConfig.current->numberOfRows;
+    editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows = 0;
+    editor_scan_syntax_parallel();
+    if (editorConfig.current->syntaxValidRows != rowCount) {
+        // A single processor scans the rows lazily, the chunks are still covered by the speculative test
+        printf("parallel scan skipped\n");
+        return 0;
+    }
+    bool * states = malloc(rowCount);
+    if (states == NULL) {
+        perror("syntax_scan_test");
+        return 1;
+    }
+    for (uint32_t at = 0; at < rowCount; at++) {
+        states[at] = editor_get_row(at)->hightLightOpenComment;
+    }
+    editorConfig.current->syntaxValidRows = editorConfig.current->syntaxConsistentRows = 0;
+    editor_scan_syntax(rowCount);
+    uint32_t failures = 0;
+    for (uint32_t at = 0; at < rowCount; at++) {
+        if (states[at] != editor_get_row(at)->hightLightOpenComment) {
+            printf("FAILED parallel scan: row %u\n", at);
+            failures++;
+        }
+    }
+    free(states);
+    return failures;
+}
+
+/// @brief Highlights a row on it's own
+/// @param at The index of the row
+/// @param insideComment Determines whether the row starts inside of a
+/// multiline comment
+/// @return true if the row ends inside of a multiline comment, false if not
+static bool syntax_scan_test_sequential(uint32_t at, bool insideComment) {
+    editor_row_t * row = editor_prepare_row(at);
+    return editor_highlight_columns(row, editor_reserve_highlight_columns(row->renderSize), insideComment);
+}
+
+/// @brief Scans chunks starting at every test row for both states at their
+/// start and compares them with a sequential scan
+/// @return The amount of chunks whose states differ
+static uint32_t syntax_scan_test_speculative() {
+    syntax_scan_test_fill_rows(2);
+    uint32_t rowCount = editorConfig.current->numberOfRows;
+    uint8_t states[2 * SYNTAX_SCAN_TEST_ROW_COUNT];
+    uint32_t failures = 0;
+    for (uint32_t begin = 0; begin < rowCount; begin++) {
+        syntax_scan_chunk_t chunk = {begin, rowCount, states};
+        editor_scan_syntax_chunk(&chunk);
+        for (uint8_t startState = 0; startState < 2; startState++) {
+            bool insideComment = startState;
+            for (uint32_t at = begin; at < rowCount; at++) {
+                insideComment = syntax_scan_test_sequential(at, insideComment);
+                if (((states[at - begin] >> startState) & 1) != insideComment) {
+                    printf("FAILED chunk starting at row %u inside of a comment %d: row %u\n", begin, startState, at);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+    return failures;
+}